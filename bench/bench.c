@@ -0,0 +1,368 @@
+/*
+ *  Copyright 2015 Masatoshi Teruya. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a 
+ *  copy of this software and associated documentation files (the "Software"), 
+ *  to deal in the Software without restriction, including without limitation 
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ *  and/or sell copies of the Software, and to permit persons to whom the 
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL 
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ *  bench.c
+ *  lua-groonga
+ *
+ */
+
+// baseline of the operations that benchmarked by bench.lua.
+// the module is linked statically to run bench.lua with -s option.
+
+#include "../src/lgroonga.h"
+#include <stdio.h>
+#include <lualib.h>
+
+#define NTABLES     100
+#define NCOLUMNS    10
+#define NLOOKUP     100000
+
+static int NRESULTS = 0;
+
+
+// MARK: helpers
+
+static void result( const char *name, uint64_t n, uint64_t ns )
+{
+    double sec = (double)ns / 1e9;
+    
+    printf( "%s{\"name\":\"%s\",\"n\":%llu,\"sec\":%.9f,\"ops\":%.3f,"
+            "\"nsop\":%.3f}", NRESULTS++ ? "," : "", name,
+            (unsigned long long)n, sec, sec > 0 ? (double)n / sec : 0,
+            n ? (double)ns / (double)n : 0 );
+}
+
+
+static void check( grn_ctx *ctx, int ok, const char *what )
+{
+    if( !ok ){
+        fprintf( stderr, "%s: %s\n", what, ctx->errbuf );
+        exit( EXIT_FAILURE );
+    }
+}
+
+
+// execute a command and discard the output
+static void execute( grn_ctx *ctx, const char *cmd, size_t len )
+{
+    char *out = NULL;
+    unsigned int olen = 0;
+    int flags = 0;
+    
+    grn_ctx_send( ctx, cmd, (unsigned int)len, 0 );
+    check( ctx, ctx->rc == GRN_SUCCESS, cmd );
+    do {
+        grn_ctx_recv( ctx, &out, &olen, &flags );
+    } while( flags & GRN_CTX_MORE );
+}
+
+
+// MARK: schema
+
+static void bench_schema( grn_ctx *ctx, const char *path )
+{
+    grn_obj *db = grn_db_create( ctx, path, NULL );
+    grn_obj *u32 = NULL;
+    char name[64];
+    uint64_t t0 = 0;
+    int i, j;
+    
+    check( ctx, db != NULL, "grn_db_create" );
+    u32 = grn_ctx_at( ctx, GRN_DB_UINT32 );
+    for( i = 1; i <= NTABLES; i++ )
+    {
+        grn_obj *tbl = NULL;
+        int len = snprintf( name, sizeof( name ), "tbl%d", i );
+        
+        tbl = grn_table_create( ctx, name, (unsigned int)len, NULL,
+                                GRN_OBJ_TABLE_HASH_KEY|GRN_OBJ_PERSISTENT,
+                                NULL, NULL );
+        check( ctx, tbl != NULL, "grn_table_create" );
+        for( j = 1; j <= NCOLUMNS; j++ ){
+            len = snprintf( name, sizeof( name ), "col%d", j );
+            check( ctx, grn_column_create( ctx, tbl, name, (unsigned int)len,
+                                           NULL, GRN_OBJ_COLUMN_SCALAR|
+                                           GRN_OBJ_PERSISTENT, u32 ) != NULL,
+                   "grn_column_create" );
+        }
+    }
+    grn_obj_flush_recursive( ctx, db );
+    grn_obj_close( ctx, db );
+    
+    // open
+    t0 = lgrn_clock_ns();
+    for( i = 0; i < 100; i++ ){
+        check( ctx, ( db = grn_db_open( ctx, path ) ) != NULL, "grn_db_open" );
+        grn_obj_close( ctx, db );
+    }
+    result( "open", 100, lgrn_clock_ns() - t0 );
+    check( ctx, ( db = grn_db_open( ctx, path ) ) != NULL, "grn_db_open" );
+    
+    // table lookup
+    t0 = lgrn_clock_ns();
+    for( i = 0; i < NLOOKUP; i++ ){
+        int len = snprintf( name, sizeof( name ), "tbl%d", i % NTABLES + 1 );
+        grn_obj *tbl = grn_ctx_get( ctx, name, len );
+        
+        check( ctx, tbl != NULL, "grn_ctx_get" );
+        grn_obj_unlink( ctx, tbl );
+    }
+    result( "db:table", NLOOKUP, lgrn_clock_ns() - t0 );
+    
+    // column lookup
+    t0 = lgrn_clock_ns();
+    for( i = 0; i < NLOOKUP; i++ ){
+        int len = snprintf( name, sizeof( name ), "tbl1.col%d",
+                            i % NCOLUMNS + 1 );
+        grn_obj *col = grn_ctx_get( ctx, name, len );
+        
+        check( ctx, col != NULL, "grn_ctx_get" );
+        grn_obj_unlink( ctx, col );
+    }
+    result( "tbl:column", NLOOKUP, lgrn_clock_ns() - t0 );
+    
+    // table iteration
+    t0 = lgrn_clock_ns();
+    for( i = 0; i < 1000; i++ )
+    {
+        grn_table_cursor *cur = grn_table_cursor_open( ctx, db, NULL, 0, NULL,
+                                                       0, 0, -1,
+                                                       GRN_CURSOR_BY_ID );
+        
+        check( ctx, cur != NULL, "grn_table_cursor_open" );
+        while( grn_table_cursor_next( ctx, cur ) != GRN_ID_NIL ){
+            void *key = NULL;
+            grn_table_cursor_get_key( ctx, cur, &key );
+        }
+        grn_table_cursor_close( ctx, cur );
+    }
+    result( "db:tables(name)", 1000, lgrn_clock_ns() - t0 );
+    
+    // column iteration
+    t0 = lgrn_clock_ns();
+    for( i = 0; i < 10000; i++ )
+    {
+        grn_obj *tbl = grn_ctx_get( ctx, "tbl1", 4 );
+        grn_hash *cols = grn_hash_create( ctx, NULL, sizeof( grn_id ), 0,
+                                          GRN_OBJ_TABLE_HASH_KEY|
+                                          GRN_HASH_TINY );
+        
+        check( ctx, cols != NULL, "grn_hash_create" );
+        grn_table_columns( ctx, tbl, NULL, 0, (grn_obj*)cols );
+        grn_hash_close( ctx, cols );
+        grn_obj_unlink( ctx, tbl );
+    }
+    result( "tbl:columns(id)", 10000, lgrn_clock_ns() - t0 );
+}
+
+
+// MARK: records
+
+static void bench_records( grn_ctx *ctx, unsigned long nrec )
+{
+    char name[64];
+    char *cmd = NULL;
+    size_t cap = 64 * 1024 * 1024;
+    size_t len = 0;
+    uint64_t t0 = 0;
+    unsigned long i = 0;
+    
+    if( !( cmd = malloc( cap ) ) ){
+        perror( "malloc" );
+        exit( EXIT_FAILURE );
+    }
+    
+    snprintf( name, sizeof( name ), "Records%lu", nrec );
+    len = (size_t)snprintf( cmd, cap, "table_create %s TABLE_HASH_KEY "
+                            "ShortText", name );
+    execute( ctx, cmd, len );
+    len = (size_t)snprintf( cmd, cap, "column_create %s value COLUMN_SCALAR "
+                            "UInt32", name );
+    execute( ctx, cmd, len );
+    
+    // insert by 1000 records
+    t0 = lgrn_clock_ns();
+    for( i = 1; i <= nrec; i += 1000 )
+    {
+        unsigned long j = i;
+        
+        len = (size_t)snprintf( cmd, cap, "load --table %s --values '[",
+                                name );
+        for(; j < i + 1000 && j <= nrec; j++ ){
+            len += (size_t)snprintf( cmd + len, cap - len,
+                                     "%s{\"_key\":\"k%lu\",\"value\":%lu}",
+                                     j == i ? "" : ",", j, j );
+        }
+        len += (size_t)snprintf( cmd + len, cap - len, "]'" );
+        execute( ctx, cmd, len );
+    }
+    snprintf( cmd, cap, "insert/%lu", nrec );
+    result( cmd, nrec, lgrn_clock_ns() - t0 );
+    
+    // lookup
+    t0 = lgrn_clock_ns();
+    for( i = 1; i <= 1000; i++ ){
+        len = (size_t)snprintf( cmd, cap, "select %s --filter '_key == "
+                                "\"k%lu\"' --output_columns _id", name,
+                                i * 7 % nrec + 1 );
+        execute( ctx, cmd, len );
+    }
+    snprintf( cmd, cap, "lookup/%lu", nrec );
+    result( cmd, 1000, lgrn_clock_ns() - t0 );
+    
+    // scan
+    t0 = lgrn_clock_ns();
+    len = (size_t)snprintf( cmd, cap, "select %s --limit -1 "
+                            "--output_columns _id,value", name );
+    execute( ctx, cmd, len );
+    snprintf( cmd, cap, "scan/%lu", nrec );
+    result( cmd, nrec, lgrn_clock_ns() - t0 );
+    
+    // select
+    t0 = lgrn_clock_ns();
+    for( i = 1; i <= 100; i++ ){
+        len = (size_t)snprintf( cmd, cap, "select %s --filter 'value < %lu' "
+                                "--sort_keys -value --limit 10", name,
+                                nrec / 10 );
+        execute( ctx, cmd, len );
+    }
+    snprintf( cmd, cap, "select/%lu", nrec );
+    result( cmd, 100, lgrn_clock_ns() - t0 );
+    
+    free( cmd );
+}
+
+
+// MARK: lua driver
+
+// monotonic clock in seconds for bench.lua
+static int monotime_lua( lua_State *L )
+{
+    lua_pushnumber( L, (lua_Number)lgrn_clock_ns() / 1e9 );
+    return 1;
+}
+
+
+static int run_script( const char *script, const char *path,
+                       const char *nrecs )
+{
+    lua_State *L = luaL_newstate();
+    int rc = 0;
+    
+    if( !L ){
+        fprintf( stderr, "failed to create lua_State\n" );
+        return EXIT_FAILURE;
+    }
+    luaL_openlibs( L );
+    
+    // preload statically linked module
+    lua_getglobal( L, "package" );
+    lua_getfield( L, -1, "preload" );
+    lua_pushcfunction( L, luaopen_groonga );
+    lua_setfield( L, -2, "groonga" );
+    lua_pop( L, 2 );
+    lua_pushcfunction( L, monotime_lua );
+    lua_setglobal( L, "bench_monotime" );
+    
+    // arg table
+    lua_newtable( L );
+    lua_pushstring( L, script );
+    lua_rawseti( L, -2, 0 );
+    lua_pushstring( L, path );
+    lua_rawseti( L, -2, 1 );
+    lua_pushstring( L, nrecs );
+    lua_rawseti( L, -2, 2 );
+    lua_setglobal( L, "arg" );
+    
+    if( luaL_dofile( L, script ) ){
+        fprintf( stderr, "%s\n", lua_tostring( L, -1 ) );
+        rc = EXIT_FAILURE;
+    }
+    lua_close( L );
+    
+    return rc;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    const char *script = NULL;
+    const char *nrecs = "10000,100000";
+    const char *path = NULL;
+    const char *ptr = NULL;
+    grn_ctx ctx;
+    int opt = 0;
+    
+    while( ( opt = getopt( argc, argv, "n:s:" ) ) != -1 )
+    {
+        switch( opt ){
+            case 'n':
+                nrecs = optarg;
+            break;
+            case 's':
+                script = optarg;
+            break;
+            default:
+                fprintf( stderr, "usage: %s [-n nrecords,...] [-s bench.lua] "
+                         "dbpath\n", argv[0] );
+                return EXIT_FAILURE;
+        }
+    }
+    if( optind >= argc ){
+        fprintf( stderr, "usage: %s [-n nrecords,...] [-s bench.lua] "
+                 "dbpath\n", argv[0] );
+        return EXIT_FAILURE;
+    }
+    path = argv[optind];
+    
+    // run bench.lua with the statically linked module
+    if( script ){
+        return run_script( script, path, nrecs );
+    }
+    
+    grn_init();
+    grn_ctx_init( &ctx, 0 );
+    
+    printf( "{\"driver\":\"c\",\"version\":\"%s\",\"results\":[",
+            grn_get_version() );
+    bench_schema( &ctx, path );
+    for( ptr = nrecs; *ptr; )
+    {
+        char *end = NULL;
+        unsigned long nrec = strtoul( ptr, &end, 10 );
+        
+        if( end == ptr ){
+            break;
+        }
+        else if( nrec ){
+            bench_records( &ctx, nrec );
+        }
+        ptr = *end == ',' ? end + 1 : end;
+    }
+    printf( "]}\n" );
+    
+    grn_obj_remove( &ctx, grn_ctx_db( &ctx ) );
+    grn_ctx_fin( &ctx );
+    grn_fin();
+    
+    return EXIT_SUCCESS;
+}
+
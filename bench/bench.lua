@@ -0,0 +1,259 @@
+--[[
+  benchmark of lua-groonga
+
+  usage: lua bench/bench.lua [dbpath [nrecords,...]]
+
+  results are written to stdout as JSON.
+--]]
+local groonga = require('groonga');
+local PATH = arg and arg[1] or './db/benchdb';
+local NRECORDS = {};
+local RESULTS = {};
+-- wall clock in seconds. os.clock measures CPU time that does not include
+-- the time waiting for I/O.
+local clock, CLOCK;
+do
+    local ok, mod;
+
+    -- monotonic clock of bench.c
+    if type( bench_monotime ) == 'function' then
+        clock, CLOCK = bench_monotime, 'monotonic';
+    end
+    -- luaposix
+    if not clock then
+        ok, mod = pcall( require, 'posix.time' );
+        if ok and mod.clock_gettime then
+            clock = function()
+                local ts = mod.clock_gettime( mod.CLOCK_MONOTONIC );
+                return ts.tv_sec + ts.tv_nsec * 1e-9;
+            end
+            CLOCK = 'monotonic';
+        end
+    end
+    -- luasocket
+    if not clock then
+        ok, mod = pcall( require, 'socket' );
+        if ok and mod.gettime then
+            clock, CLOCK = mod.gettime, 'realtime';
+        end
+    end
+    if not clock then
+        io.stderr:write( 'wall clock is not available: use os.clock\n' );
+        clock, CLOCK = os.clock, 'cpu';
+    end
+end
+
+for n in string.gmatch( arg and arg[2] or '10000,100000', '%d+' ) do
+    NRECORDS[#NRECORDS + 1] = tonumber( n );
+end
+
+
+-- MARK: helpers
+
+local function check( ... )
+    local v, err = ...;
+
+    if v == nil or v == false then
+        error( tostring( err ), 2 );
+    end
+
+    return ...;
+end
+
+
+-- run fn( n ) and record the throughput
+local function measure( name, n, fn, ... )
+    local elapsed;
+
+    collectgarbage('collect');
+    elapsed = clock();
+    fn( n, ... );
+    elapsed = clock() - elapsed;
+
+    RESULTS[#RESULTS + 1] = {
+        name = name,
+        n = n,
+        sec = elapsed,
+        ops = elapsed > 0 and n / elapsed or 0,
+        nsop = n > 0 and elapsed * 1e9 / n or 0
+    };
+end
+
+
+local function encode( v )
+    local t = type( v );
+
+    if t == 'number' then
+        return string.format( '%.17g', v );
+    elseif t == 'string' then
+        return ( string.format( '%q', v ):gsub( '\\\n', '\\n' ) );
+    elseif t == 'table' then
+        local list = {};
+
+        if #v > 0 then
+            for i = 1, #v do
+                list[i] = encode( v[i] );
+            end
+            return '[' .. table.concat( list, ',' ) .. ']';
+        end
+        for k, val in pairs( v ) do
+            list[#list + 1] = encode( tostring( k ) ) .. ':' .. encode( val );
+        end
+        table.sort( list );
+        return '{' .. table.concat( list, ',' ) .. '}';
+    end
+
+    return tostring( v );
+end
+
+
+local function setup( path )
+    local g = groonga.new( path );
+
+    if g then
+        g:remove();
+        g = nil;
+        collectgarbage('collect');
+    end
+
+    return check( groonga.new( path, true ) );
+end
+
+
+-- MARK: binding overhead
+
+local function benchSchema( g )
+    local N = 100000;
+    local t;
+
+    for i = 1, 100 do
+        t = check( g:tableCreate({ name = 'tbl' .. i, persistent = true }) );
+        for j = 1, 10 do
+            check( t:columnCreate({
+                name = 'col' .. j,
+                valType = 'UINT32',
+                persistent = true
+            }) );
+        end
+    end
+    check( g:flush() );
+    -- release the table objects that hold a database object
+    t = nil;
+
+    measure( 'open', 100, function( n )
+        for i = 1, n do
+            g = nil;
+            collectgarbage('collect');
+            g = check( groonga.new( PATH ) );
+        end
+    end);
+
+    measure( 'db:table', N, function( n )
+        for i = 1, n do
+            check( g:table( 'tbl' .. ( i % 100 + 1 ) ) );
+        end
+    end);
+
+    t = check( g:table('tbl1') );
+    measure( 'tbl:column', N, function( n )
+        for i = 1, n do
+            check( t:column( 'col' .. ( i % 10 + 1 ) ) );
+        end
+    end);
+
+    for _, mode in ipairs({ 'name', 'id', 'object', 'light' }) do
+        measure( 'db:tables(' .. mode .. ')', 1000, function( n )
+            for i = 1, n do
+                for name, v in g:tables( mode ) do end
+            end
+        end);
+        measure( 'tbl:columns(' .. mode .. ')', 10000, function( n )
+            for i = 1, n do
+                for name, v in t:columns( mode ) do end
+            end
+        end);
+    end
+
+    return g;
+end
+
+
+-- MARK: core operations
+
+local function benchRecords( g, nrec )
+    local tname = 'Records' .. nrec;
+    local batch = 1000;
+    local cmds = {};
+
+    check( g:execute( 'table_create ' .. tname .. ' TABLE_HASH_KEY ShortText' ) );
+    check( g:execute( 'column_create ' .. tname .. ' value COLUMN_SCALAR UInt32' ) );
+
+    measure( 'insert/' .. nrec, nrec, function( n )
+        local values = {};
+
+        for i = 1, n do
+            values[#values + 1] = string.format(
+                '{"_key":"k%d","value":%d}', i, i
+            );
+            if #values == batch or i == n then
+                check( g:execute( 'load --table ' .. tname ..
+                                  ' --values \'[' .. table.concat( values, ',' ) ..
+                                  ']\'' ) );
+                values = {};
+            end
+        end
+    end);
+
+    measure( 'lookup/' .. nrec, 1000, function( n )
+        for i = 1, n do
+            check( g:execute( 'select ' .. tname ..
+                              ' --filter \'_key == "k' .. ( i * 7 % nrec + 1 ) ..
+                              '"\' --output_columns _id' ) );
+        end
+    end);
+
+    for i = 1, 10 do
+        cmds[i] = 'select ' .. tname .. ' --filter \'_key == "k' .. i ..
+                  '"\' --output_columns _id';
+    end
+    measure( 'lookup-batch/' .. nrec, 1000, function( n )
+        for i = 1, n, #cmds do
+            check( g:executeBatch( cmds ) );
+        end
+    end);
+
+    measure( 'scan/' .. nrec, nrec, function( n )
+        check( g:execute( 'select ' .. tname ..
+                          ' --limit -1 --output_columns _id,value' ) );
+    end);
+
+    measure( 'select/' .. nrec, 100, function( n )
+        for i = 1, n do
+            check( g:execute( 'select ' .. tname ..
+                              ' --filter \'value < ' .. ( nrec / 10 ) ..
+                              '\' --sort_keys -value --limit 10' ) );
+        end
+    end);
+end
+
+
+-- MARK: main
+
+local g = setup( PATH );
+
+g = benchSchema( g );
+for _, nrec in ipairs( NRECORDS ) do
+    benchRecords( g, nrec );
+end
+
+io.write( encode({
+    driver = 'lua',
+    clock = CLOCK,
+    version = groonga.version(),
+    lua = _VERSION,
+    results = RESULTS,
+    stats = g:stats(),
+    memory = groonga.memory()
+}), '\n' );
+
+g:remove();
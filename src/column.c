@@ -57,6 +57,17 @@
 #define CHECK_EXISTS( L, c ) \
     CHECK_EXISTS_EX( L, c, CHECK_RET_NIL )
 
+#define CHECK_WRITABLE_EX( L, c, CHECK_RET ) do{ \
+    if( (c)->t->g->readonly ){ \
+        CHECK_RET; \
+        lua_pushstring( L, LGRN_EREADONLY ); \
+        return 2; \
+    } \
+}while(0)
+
+#define CHECK_WRITABLE( L, c ) \
+    CHECK_WRITABLE_EX( L, c, CHECK_RET_NIL )
+
 
 // MARK: column API
 
@@ -114,9 +125,7 @@ static int val_type_lua( lua_State *L )
     CHECK_EXISTS( L, c );
     id = grn_obj_get_range( lgrn_get_ctx( c->t->g ), c->col );
     if( id != GRN_ID_NIL ){
-        size_t len = 0;
-        const char *name = lgrn_i2n_data( L, (int)id, &len );
-        lua_pushlstring( L, name, len );
+        lgrn_type_push( L, c->t->g, id );
     }
     else {
         lua_pushnil( L );
@@ -145,6 +154,93 @@ static int compress_lua( lua_State *L )
 }
 
 
+// read values of scalar column and report the size of decoded values, the 
+// size of column files and the average time to read a value.
+static int compression_stats_lua( lua_State *L )
+{
+    lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
+    lua_Integer limit = luaL_optinteger( L, 2, -1 );
+    grn_ctx *ctx = NULL;
+    const char *path = NULL;
+    grn_table_cursor *cur = NULL;
+    grn_obj buf;
+    grn_id id = GRN_ID_NIL;
+    size_t nrec = 0;
+    size_t total = 0;
+    size_t raw = 0;
+    size_t stored = 0;
+    int estimated = 0;
+    uint64_t ns = 0;
+    uint64_t t0 = 0;
+    
+    CHECK_EXISTS( L, c );
+    if( limit < -1 || limit > INT32_MAX ){
+        return luaL_argerror( L, 2, "invalid limit value" );
+    }
+    else if( c->col->header.type != GRN_COLUMN_VAR_SIZE ||
+             ( c->col->header.flags & GRN_OBJ_COLUMN_TYPE_MASK ) != 
+             GRN_OBJ_COLUMN_SCALAR ){
+        lua_pushnil( L );
+        lua_pushliteral( L, "column is not a variable size scalar column" );
+        return 2;
+    }
+    ctx = lgrn_get_ctx( c->t->g );
+    
+    // size of column files
+    lua_settop( L, 1 );
+    lua_newtable( L );
+    if( ( path = grn_obj_path( ctx, c->col ) ) && 
+        ( lgrn_files_collect( L, path ) != 0 || 
+          lgrn_files_usage( L, 2, &stored ) != 0 ) ){
+        lua_pushnil( L );
+        lua_pushstring( L, strerror( errno ) );
+        return 2;
+    }
+    lua_pop( L, 1 );
+    
+    // decode values
+    if( !( cur = grn_table_cursor_open( ctx, c->t->tbl, NULL, 0, NULL, 0, 0, 
+                                        (int)limit, GRN_CURSOR_BY_ID ) ) ){
+        lua_pushnil( L );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    GRN_TEXT_INIT( &buf, 0 );
+    while( ( id = grn_table_cursor_next( ctx, cur ) ) != GRN_ID_NIL )
+    {
+        GRN_BULK_REWIND( &buf );
+        t0 = lgrn_clock_ns();
+        grn_obj_get_value( ctx, c->col, id, &buf );
+        ns += lgrn_clock_ns() - t0;
+        raw += GRN_BULK_VSIZE( &buf );
+        nrec++;
+    }
+    GRN_OBJ_FIN( ctx, &buf );
+    grn_table_cursor_close( ctx, cur );
+    
+    // storedBytes is the size of whole column files, so rawBytes of the 
+    // sampled records is scaled to the estimated size of all records
+    total = grn_table_size( ctx, c->t->tbl );
+    if( nrec && nrec < total ){
+        raw = (size_t)( (double)raw * ( (double)total / (double)nrec ) );
+        estimated = 1;
+    }
+    
+    lua_createtable( L, 0, 5 );
+    lstate_int2tbl( L, "records", nrec );
+    lstate_int2tbl( L, "rawBytes", raw );
+    lua_pushliteral( L, "estimated" );
+    lua_pushboolean( L, estimated );
+    lua_rawset( L, -3 );
+    lstate_int2tbl( L, "storedBytes", stored );
+    lua_pushliteral( L, "decodeTime" );
+    lua_pushnumber( L, nrec ? (lua_Number)ns / (lua_Number)nrec / 1000.0 : 0 );
+    lua_rawset( L, -3 );
+    
+    return 1;
+}
+
+
 static int persistent_lua( lua_State *L )
 {
     lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
@@ -243,7 +339,7 @@ static int db_lua( lua_State *L )
 }
 
 
-static int rename_lua( lua_State *L )
+static int rename_column( lua_State *L )
 {
     lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
     grn_ctx *ctx = NULL;
@@ -251,6 +347,7 @@ static int rename_lua( lua_State *L )
     const char *name = NULL;
     
     CHECK_EXISTS_EX( L, c, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, c, CHECK_RET_FALSE );
     ctx = lgrn_get_ctx( c->t->g );
     name = luaL_checklstring( L, 2, &len );
     
@@ -266,6 +363,7 @@ static int rename_lua( lua_State *L )
         lua_pushfstring( L, ctx->errbuf );
         return 1;
     }
+    lgrn_schema_changed( c->t->g );
     
     lua_pushboolean( L, 1 );
     
@@ -273,12 +371,102 @@ static int rename_lua( lua_State *L )
 }
 
 
-static int remove_lua( lua_State *L )
+static int rename_lua( lua_State *L )
+{
+    lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
+    
+    return lgrn_stats_measure( L, c->t->g, LGRN_OP_DDL, rename_column( L ) );
+}
+
+
+static int lock_lua( lua_State *L )
+{
+    lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
+    int timeout = (int)luaL_optinteger( L, 2, grn_get_lock_timeout() );
+    grn_ctx *ctx = NULL;
+    
+    CHECK_EXISTS_EX( L, c, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, c, CHECK_RET_FALSE );
+    ctx = lgrn_get_ctx( c->t->g );
+    if( grn_obj_lock( ctx, c->col, GRN_ID_NIL, timeout ) != GRN_SUCCESS ){
+        lua_pushboolean( L, 0 );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+static int unlock_lua( lua_State *L )
+{
+    lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
+    
+    CHECK_EXISTS_EX( L, c, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, c, CHECK_RET_FALSE );
+    ctx = lgrn_get_ctx( c->t->g );
+    if( grn_obj_unlock( ctx, c->col, GRN_ID_NIL ) != GRN_SUCCESS ){
+        lua_pushboolean( L, 0 );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+static int is_locked_lua( lua_State *L )
+{
+    lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
+    
+    CHECK_EXISTS_EX( L, c, CHECK_RET_FALSE );
+    lua_pushboolean( L, grn_obj_is_locked( lgrn_get_ctx( c->t->g ), c->col ) );
+    
+    return 1;
+}
+
+
+// force clear a lock
+static int clear_lock_lua( lua_State *L )
+{
+    lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
+    
+    CHECK_EXISTS_EX( L, c, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, c, CHECK_RET_FALSE );
+    ctx = lgrn_get_ctx( c->t->g );
+    if( grn_obj_clear_lock( ctx, c->col ) != GRN_SUCCESS ){
+        lua_pushboolean( L, 0 );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+static int remove_column( lua_State *L )
 {
     lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
     
     CHECK_EXISTS_EX( L, c, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, c, CHECK_RET_FALSE );
     grn_obj_remove( lgrn_get_ctx( c->t->g ), c->col );
+    // mark the cached object of same column as removed
+    if( c->light && 
+        lgrn_refget_obj( L, c->t->g, c->id, GROONGA_COLUMN_MT ) ){
+        lgrn_col_t *cached = lua_touserdata( L, -1 );
+        
+        cached->removed = 1;
+        cached->col = NULL;
+        lua_pop( L, 1 );
+    }
+    lgrn_refdel_obj( L, c->t->g, c->id );
+    lgrn_schema_changed( c->t->g );
     c->removed = 1;
     c->col = NULL;
     lua_pushboolean( L, 1 );
@@ -287,6 +475,44 @@ static int remove_lua( lua_State *L )
 }
 
 
+static int remove_lua( lua_State *L )
+{
+    lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
+    
+    return lgrn_stats_measure( L, c->t->g, LGRN_OP_DDL, remove_column( L ) );
+}
+
+
+static int defrag_lua( lua_State *L )
+{
+    lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
+    lua_Integer threshold = luaL_optinteger( L, 2, 0 );
+    grn_ctx *ctx = NULL;
+    int nsegs = 0;
+    
+    CHECK_EXISTS( L, c );
+    CHECK_WRITABLE( L, c );
+    if( threshold < 0 || threshold > INT32_MAX ){
+        return luaL_argerror( L, 2, "invalid threshold value" );
+    }
+    
+    ctx = lgrn_get_ctx( c->t->g );
+    nsegs = grn_obj_defrag( ctx, c->col, (int)threshold );
+    if( nsegs ){
+        lgrn_wrote( c->t->g );
+    }
+    // groonga error
+    if( ctx->rc != GRN_SUCCESS ){
+        lua_pushnil( L );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    lua_pushinteger( L, nsegs );
+    
+    return 1;
+}
+
+
 static int tostring_lua( lua_State *L )
 {
     return lgrn_tostring( L, MODULE_MT );
@@ -307,6 +533,401 @@ static int gc_lua( lua_State *L )
 }
 
 
+// MARK: index column API
+
+#define CHECK_INDEX( L, c ) do{ \
+    if( (c)->col->header.type != GRN_COLUMN_INDEX ){ \
+        lua_pushnil( L ); \
+        lua_pushliteral( L, "column is not an index column" ); \
+        return 2; \
+    } \
+}while(0)
+
+
+// posting list cursor
+typedef struct {
+    lgrn_col_t *c;
+    grn_ii_cursor *cur;
+    // iterate each position of postings
+    uint8_t withpos;
+    // cursor points to a posting
+    uint8_t inrec;
+} lgrn_postings_t;
+
+
+static void postings_close( lgrn_postings_t *p )
+{
+    // cursor refers to the index that has been removed
+    if( p->cur && !p->c->removed && !p->c->t->removed && 
+        !p->c->t->g->removed ){
+        grn_ii_cursor_close( lgrn_get_ctx( p->c->t->g ), p->cur );
+    }
+    p->cur = NULL;
+}
+
+
+static int postings_gc_lua( lua_State *L )
+{
+    postings_close( lua_touserdata( L, 1 ) );
+    
+    return 0;
+}
+
+
+// lookup a term id from the lexicon of index. grn_table_get normalizes the 
+// term with the normalizer of lexicon.
+static grn_id term_id( grn_ctx *ctx, lgrn_col_t *c, const char *term, 
+                       size_t len )
+{
+    grn_obj *lexicon = NULL;
+    grn_id tid = GRN_ID_NIL;
+    
+    if( len <= GRN_TABLE_MAX_KEY_SIZE && 
+        ( lexicon = grn_ctx_at( ctx, c->col->header.domain ) ) ){
+        tid = grn_table_get( ctx, lexicon, term, (unsigned int)len );
+        grn_obj_unlink( ctx, lexicon );
+    }
+    
+    return tid;
+}
+
+
+static int postings_next_lua( lua_State *L )
+{
+    lgrn_postings_t *p = lua_touserdata( L, lua_upvalueindex( 1 ) );
+    lgrn_col_t *c = p->c;
+    grn_ctx *ctx = NULL;
+    grn_posting *post = NULL;
+    
+    CHECK_EXISTS( L, c );
+    if( !p->cur ){
+        return 0;
+    }
+    ctx = lgrn_get_ctx( c->t->g );
+    
+    // next position of current posting, or first position of next posting
+    if( p->withpos )
+    {
+        while( !p->inrec || 
+               !( post = grn_ii_cursor_next_pos( ctx, p->cur ) ) )
+        {
+            if( !grn_ii_cursor_next( ctx, p->cur ) ){
+                break;
+            }
+            p->inrec = 1;
+        }
+    }
+    else {
+        post = grn_ii_cursor_next( ctx, p->cur );
+    }
+    
+    if( !post ){
+        postings_close( p );
+        return 0;
+    }
+    lua_pushinteger( L, post->rid );
+    lua_pushinteger( L, post->sid );
+    lua_pushinteger( L, post->pos );
+    lua_pushinteger( L, post->tf );
+    lua_pushinteger( L, post->weight );
+    
+    return 5;
+}
+
+
+static int postings_lua( lua_State *L )
+{
+    lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
+    size_t len = 0;
+    const char *term = luaL_checklstring( L, 2, &len );
+    int withpos = 0;
+    grn_ctx *ctx = NULL;
+    grn_ii *ii = NULL;
+    grn_id tid = GRN_ID_NIL;
+    lgrn_postings_t *p = NULL;
+    
+    CHECK_EXISTS( L, c );
+    CHECK_INDEX( L, c );
+    
+    // check arguments
+    if( !lua_isnoneornil( L, 3 ) ){
+        lua_settop( L, 3 );
+        luaL_checktype( L, 3, LUA_TTABLE );
+        withpos = lstate_toptboolean( L, "withPositions", 0 );
+    }
+    lua_settop( L, 1 );
+    ctx = lgrn_get_ctx( c->t->g );
+    ii = (grn_ii*)c->col;
+    
+    if( !( p = lua_newuserdata( L, sizeof( lgrn_postings_t ) ) ) ){
+        lua_pushnil( L );
+        lua_pushstring( L, strerror( errno ) );
+        return 2;
+    }
+    *p = (lgrn_postings_t){
+        .c = c,
+        .cur = NULL,
+        .withpos = (uint8_t)withpos,
+        .inrec = 0
+    };
+    lstate_setmetatable( L, GROONGA_POSTINGS_MT );
+    
+    // iterator of the term that is not in the lexicon returns nothing
+    if( ( tid = term_id( ctx, c, term, len ) ) != GRN_ID_NIL && 
+        !( p->cur = grn_ii_cursor_open( ctx, ii, tid, GRN_ID_NIL, GRN_ID_MAX, 
+                                        (int)grn_ii_get_n_elements( ctx, ii ),
+                                        0 ) ) &&
+        ctx->rc != GRN_SUCCESS ){
+        lua_pushnil( L );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    
+    // upvalues: cursor, column
+    lua_pushvalue( L, 1 );
+    lua_pushcclosure( L, postings_next_lua, 2 );
+    
+    return 1;
+}
+
+
+static int estimate_size_lua( lua_State *L )
+{
+    lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
+    size_t len = 0;
+    const char *term = luaL_checklstring( L, 2, &len );
+    grn_ctx *ctx = NULL;
+    grn_id tid = GRN_ID_NIL;
+    
+    CHECK_EXISTS( L, c );
+    CHECK_INDEX( L, c );
+    ctx = lgrn_get_ctx( c->t->g );
+    
+    if( ( tid = term_id( ctx, c, term, len ) ) == GRN_ID_NIL ){
+        lua_pushinteger( L, 0 );
+    }
+    else {
+        lua_pushinteger( L, grn_ii_estimate_size( ctx, (grn_ii*)c->col, 
+                                                  tid ) );
+    }
+    
+    return 1;
+}
+
+
+// numeric key of lexicon
+typedef union {
+    int8_t i8;
+    uint8_t u8;
+    int16_t i16;
+    uint16_t u16;
+    int32_t i32;
+    uint32_t u32;
+    int64_t i64;
+    uint64_t u64;
+    double f;
+} lgrn_numkey_t;
+
+// the value must be an integer in the range of field. (double)max + 1 is 
+// compared as a strict upper limit, since INT64_MAX and UINT64_MAX are 
+// rounded up to 2^63 and 2^64 that cannot be converted to the field.
+#define RANGE_KEY_INT( v, min, max, field, key, size ) do{ \
+    if( (v) != floor( v ) || (v) < (double)(min) || \
+        (v) >= (double)(max) + 1.0 ){ \
+        return -1; \
+    } \
+    (key)->field = (v); \
+    *(size) = sizeof( (key)->field ); \
+}while(0)
+
+// encode a number of field k of table at the top of stack as a key of 
+// domain. returns 0 if value is nil, -1 if value is not a valid key.
+static int range_key( lua_State *L, const char *k, grn_id domain, 
+                      lgrn_numkey_t *key, unsigned int *size )
+{
+    lua_Number v = 0;
+    
+    *size = 0;
+    lua_getfield( L, -1, k );
+    if( lua_isnil( L, -1 ) ){
+        lua_pop( L, 1 );
+        return 0;
+    }
+    else if( lua_type( L, -1 ) != LUA_TNUMBER ){
+        lua_pop( L, 1 );
+        return -1;
+    }
+    v = lua_tonumber( L, -1 );
+    lua_pop( L, 1 );
+    
+    switch( domain ){
+        case GRN_DB_INT8:
+            RANGE_KEY_INT( v, INT8_MIN, INT8_MAX, i8, key, size );
+        break;
+        case GRN_DB_UINT8:
+            RANGE_KEY_INT( v, 0, UINT8_MAX, u8, key, size );
+        break;
+        case GRN_DB_INT16:
+            RANGE_KEY_INT( v, INT16_MIN, INT16_MAX, i16, key, size );
+        break;
+        case GRN_DB_UINT16:
+            RANGE_KEY_INT( v, 0, UINT16_MAX, u16, key, size );
+        break;
+        case GRN_DB_INT32:
+            RANGE_KEY_INT( v, INT32_MIN, INT32_MAX, i32, key, size );
+        break;
+        case GRN_DB_UINT32:
+            RANGE_KEY_INT( v, 0, UINT32_MAX, u32, key, size );
+        break;
+        case GRN_DB_INT64:
+            RANGE_KEY_INT( v, INT64_MIN, INT64_MAX, i64, key, size );
+        break;
+        case GRN_DB_UINT64:
+            RANGE_KEY_INT( v, 0, UINT64_MAX, u64, key, size );
+        break;
+        // time in seconds is stored as microseconds. fraction of 
+        // microseconds is rejected
+        case GRN_DB_TIME:
+            v = v * 1000000;
+            RANGE_KEY_INT( v, INT64_MIN, INT64_MAX, i64, key, size );
+        break;
+        case GRN_DB_FLOAT:
+            key->f = v;
+            *size = sizeof( key->f );
+        break;
+        
+        default:
+            return -1;
+    }
+    
+    return 1;
+}
+
+
+// add postings of term into the result array at the top of stack
+static int range_add( lua_State *L, grn_ctx *ctx, grn_ii *ii, grn_id tid, 
+                      grn_hash *rids, int n, int limit )
+{
+    grn_ii_cursor *cur = grn_ii_cursor_open( ctx, ii, tid, GRN_ID_NIL, 
+                                             GRN_ID_MAX, 
+                                             (int)grn_ii_get_n_elements( ctx, 
+                                                                         ii ),
+                                             0 );
+    grn_posting *post = NULL;
+    int added = 0;
+    
+    if( cur )
+    {
+        while( n != limit && ( post = grn_ii_cursor_next( ctx, cur ) ) )
+        {
+            // record that matched by other terms or sections
+            if( grn_hash_add( ctx, rids, &post->rid, sizeof( grn_id ), NULL,
+                              &added ) && added ){
+                lua_pushinteger( L, post->rid );
+                lua_rawseti( L, -2, ++n );
+            }
+        }
+        grn_ii_cursor_close( ctx, cur );
+    }
+    
+    return n;
+}
+
+
+// returns an array of record ids that matched the range of lexicon keys
+static int range_lua( lua_State *L )
+{
+    lgrn_col_t *c = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
+    grn_obj *lexicon = NULL;
+    grn_id domain = GRN_ID_NIL;
+    lgrn_numkey_t min, max;
+    unsigned int minsize = 0;
+    unsigned int maxsize = 0;
+    lua_Integer limit = -1;
+    int flags = GRN_CURSOR_BY_KEY|GRN_CURSOR_GE|GRN_CURSOR_LE;
+    grn_table_cursor *cur = NULL;
+    grn_hash *rids = NULL;
+    grn_id tid = GRN_ID_NIL;
+    int n = 0;
+    
+    CHECK_EXISTS( L, c );
+    CHECK_INDEX( L, c );
+    ctx = lgrn_get_ctx( c->t->g );
+    
+    // lexicon should be a patricia trie of numeric keys
+    if( !( lexicon = grn_ctx_at( ctx, c->col->header.domain ) ) ||
+        lexicon->header.type != GRN_TABLE_PAT_KEY ||
+        ( domain = lexicon->header.domain ) < GRN_DB_INT8 || 
+        domain > GRN_DB_TIME ){
+        if( lexicon ){
+            grn_obj_unlink( ctx, lexicon );
+        }
+        lua_pushnil( L );
+        lua_pushliteral( L, "lexicon is not a PAT_KEY table of numeric keys" );
+        return 2;
+    }
+    
+    // check arguments
+    if( !lua_isnoneornil( L, 2 ) )
+    {
+        lua_settop( L, 2 );
+        if( lua_type( L, 2 ) != LUA_TTABLE ){
+            grn_obj_unlink( ctx, lexicon );
+            luaL_checktype( L, 2, LUA_TTABLE );
+        }
+        else if( range_key( L, "min", domain, &min, &minsize ) == -1 ){
+            grn_obj_unlink( ctx, lexicon );
+            return luaL_argerror( L, 2, "invalid min value" );
+        }
+        else if( range_key( L, "max", domain, &max, &maxsize ) == -1 ){
+            grn_obj_unlink( ctx, lexicon );
+            return luaL_argerror( L, 2, "invalid max value" );
+        }
+        
+        limit = lstate_toptinteger( L, "limit", -1 );
+        if( limit < -1 || limit > INT32_MAX ){
+            grn_obj_unlink( ctx, lexicon );
+            return luaL_argerror( L, 2, "invalid limit value" );
+        }
+        else if( lstate_toptboolean( L, "desc", 0 ) ){
+            flags |= GRN_CURSOR_DESCENDING;
+        }
+    }
+    lua_settop( L, 1 );
+    
+    if( !( rids = grn_hash_create( ctx, NULL, sizeof( grn_id ), 0, 
+                                   GRN_OBJ_TABLE_HASH_KEY ) ) ){
+        grn_obj_unlink( ctx, lexicon );
+        lua_pushnil( L );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    else if( !( cur = grn_table_cursor_open( ctx, lexicon, 
+                                             minsize ? &min : NULL, minsize, 
+                                             maxsize ? &max : NULL, maxsize, 
+                                             0, -1, flags ) ) ){
+        grn_hash_close( ctx, rids );
+        grn_obj_unlink( ctx, lexicon );
+        lua_pushnil( L );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    
+    // union postings of terms in key order
+    lua_newtable( L );
+    while( n != limit && 
+           ( tid = grn_table_cursor_next( ctx, cur ) ) != GRN_ID_NIL ){
+        n = range_add( L, ctx, (grn_ii*)c->col, tid, rids, n, (int)limit );
+    }
+    grn_table_cursor_close( ctx, cur );
+    grn_hash_close( ctx, rids );
+    grn_obj_unlink( ctx, lexicon );
+    
+    return 1;
+}
+
+
 LUALIB_API int luaopen_groonga_column( lua_State *L )
 {
     struct luaL_Reg mmethods[] = {
@@ -317,6 +938,11 @@ LUALIB_API int luaopen_groonga_column( lua_State *L )
     struct luaL_Reg methods[] = {
         { "rename", rename_lua },
         { "remove", remove_lua },
+        { "defrag", defrag_lua },
+        { "lock", lock_lua },
+        { "unlock", unlock_lua },
+        { "isLocked", is_locked_lua },
+        { "clearLock", clear_lock_lua },
         { "db", db_lua },
         { "table", table_lua },
         { "name", name_lua },
@@ -324,14 +950,24 @@ LUALIB_API int luaopen_groonga_column( lua_State *L )
         { "type", type_lua },
         { "valType", val_type_lua },
         { "compress", compress_lua },
+        { "compressionStats", compression_stats_lua },
         { "persistent", persistent_lua },
         { "withWeight", with_weight_lua },
         { "withSection", with_section_lua },
         { "withPosition", with_position_lua },
+        { "postings", postings_lua },
+        { "estimateSize", estimate_size_lua },
+        { "range", range_lua },
+        { NULL, NULL }
+    };
+    
+    struct luaL_Reg postings_mmethods[] = {
+        { "__gc", postings_gc_lua },
         { NULL, NULL }
     };
     
     lgrn_register_mt( L, MODULE_MT, mmethods, methods );
+    lgrn_register_mt( L, GROONGA_POSTINGS_MT, postings_mmethods, NULL );
     
     return 0;
 }
@@ -0,0 +1,195 @@
+/*
+ *  Copyright 2015 Masatoshi Teruya. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a 
+ *  copy of this software and associated documentation files (the "Software"), 
+ *  to deal in the Software without restriction, including without limitation 
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ *  and/or sell copies of the Software, and to permit persons to whom the 
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL 
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ *  command.c
+ *  lua-groonga
+ *
+ */
+
+
+#include "lgroonga.h"
+#include <limits.h>
+
+
+// MARK: command names
+
+// commands that do not modify the database
+static const char *READONLY_CMDS[] = {
+    "column_list",
+    "dump",
+    "logical_count",
+    "logical_range_filter",
+    "logical_select",
+    "normalize",
+    "normalizer_list",
+    "object_exist",
+    "object_inspect",
+    "object_list",
+    "schema",
+    "select",
+    "status",
+    "table_list",
+    "table_tokenize",
+    "tokenize",
+    "tokenizer_list",
+    NULL
+};
+
+
+// commands that change the schema
+static const char *SCHEMA_CMDS[] = {
+    "column_create",
+    "column_remove",
+    "column_rename",
+    "logical_table_remove",
+    "object_remove",
+    "plugin_register",
+    "plugin_unregister",
+    "register",
+    "table_create",
+    "table_remove",
+    "table_rename",
+    NULL
+};
+
+
+// check the name of command is contained in the list. both of "name args" 
+// and "/d/name?args" forms are accepted.
+static int cmd_match( const char **list, const char *cmd, size_t len )
+{
+    const char *end = cmd + len;
+    const char *name = NULL;
+    size_t nlen = 0;
+    
+    // skip leading spaces
+    while( cmd < end && ( *cmd == ' ' || *cmd == '\t' ) ){
+        cmd++;
+    }
+    // skip http path prefix
+    if( end - cmd > 3 && memcmp( cmd, "/d/", 3 ) == 0 ){
+        cmd += 3;
+    }
+    
+    name = cmd;
+    while( cmd < end && *cmd != ' ' && *cmd != '\t' && *cmd != '\n' && 
+           *cmd != '?' && *cmd != '.' ){
+        cmd++;
+    }
+    nlen = (size_t)( cmd - name );
+    
+    for(; *list; list++ ){
+        if( strlen( *list ) == nlen && memcmp( *list, name, nlen ) == 0 ){
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+
+int lgrn_cmd_isreadonly( const char *cmd, size_t len )
+{
+    return cmd_match( READONLY_CMDS, cmd, len );
+}
+
+
+int lgrn_cmd_isschema( const char *cmd, size_t len )
+{
+    return cmd_match( SCHEMA_CMDS, cmd, len );
+}
+
+
+// MARK: execution
+
+// execute a command and push the output as a string, or pass each chunk of
+// output to the function at fnidx if fnidx is not 0.
+// output_type argument of the command takes precedence over otype.
+// returns -1 and pushes an error message on failure.
+int lgrn_cmd_exec( lua_State *L, lgrn_t *g, const char *cmd, size_t len, 
+                   grn_content_type otype, int fnidx )
+{
+    grn_ctx *ctx = lgrn_get_ctx( g );
+    char *out = NULL;
+    unsigned int olen = 0;
+    int flags = 0;
+    int nchunk = 0;
+    int cberr = 0;
+    grn_rc rc = GRN_SUCCESS;
+    uint64_t t0 = 0;
+    
+    if( len > UINT_MAX ){
+        lua_pushstring( L, strerror( E2BIG ) );
+        return -1;
+    }
+    
+    // output type of context is kept after execution
+    grn_ctx_set_output_type( ctx, otype );
+    LGRN_PROBE2( execute__entry, cmd, len );
+    t0 = lgrn_clock_ns();
+    grn_ctx_send( ctx, cmd, (unsigned int)len, 0 );
+    rc = ctx->rc;
+    
+    // output must be received even if failed
+    do
+    {
+        grn_ctx_recv( ctx, &out, &olen, &flags );
+        if( !olen || cberr ){
+            continue;
+        }
+        // pass a chunk to callback
+        else if( fnidx ){
+            lua_pushvalue( L, fnidx );
+            lua_pushlstring( L, out, olen );
+            // leave an error message on the stack
+            cberr = lua_pcall( L, 1, 0, 0 );
+        }
+        // push a chunk into the stack and concatenate them at last
+        else {
+            luaL_checkstack( L, 1, "too many output chunks" );
+            lua_pushlstring( L, out, olen );
+            nchunk++;
+        }
+    } while( flags & GRN_CTX_MORE );
+    t0 = lgrn_clock_ns() - t0;
+    LGRN_PROBE4( execute__return, cmd, len, t0, rc );
+    lgrn_stats_record( L, g, LGRN_OP_EXECUTE, t0, cmd, len );
+    
+    if( cberr ){
+        return -1;
+    }
+    else if( rc != GRN_SUCCESS ){
+        lua_pop( L, nchunk );
+        lua_pushstring( L, ctx->errbuf );
+        return -1;
+    }
+    else if( !fnidx )
+    {
+        if( nchunk == 0 ){
+            lua_pushliteral( L, "" );
+        }
+        else if( nchunk > 1 ){
+            lua_concat( L, nchunk );
+        }
+    }
+    
+    return 0;
+}
+
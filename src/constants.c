@@ -33,6 +33,7 @@ static int REF_N2I_DATA;
 static int REF_N2I_TABLE;
 static int REF_N2I_COLUMN;
 static int REF_N2I_COMPRESS;
+static int REF_N2I_OUTPUT;
 
 static int name2id( lua_State *L, int ref, const char *name )
 {
@@ -69,6 +70,11 @@ int lgrn_n2i_compress( lua_State *L, const char *name )
     return name2id( L, REF_N2I_COMPRESS, name );
 }
 
+int lgrn_n2i_output( lua_State *L, const char *name )
+{
+    return name2id( L, REF_N2I_OUTPUT, name );
+}
+
 
 static int REF_I2N_DATA;
 static int REF_I2N_TABLE;
@@ -188,12 +194,32 @@ void lgrn_constants_init( lua_State *L )
     lua_newtable( L );
     lstate_int2tbl( L, "ZLIB", GRN_OBJ_COMPRESS_ZLIB );
     lstate_int2tbl( L, "LZ4", GRN_OBJ_COMPRESS_LZ4 );
+#ifdef GRN_OBJ_COMPRESS_ZSTD
+    lstate_int2tbl( L, "ZSTD", GRN_OBJ_COMPRESS_ZSTD );
+#endif
     REF_N2I_COMPRESS = lstate_ref( L );
 
     lua_newtable( L );
     lstate_str2arr( L, GRN_OBJ_COMPRESS_ZLIB >> 4, "ZLIB" );
     lstate_str2arr( L, GRN_OBJ_COMPRESS_LZ4 >> 4, "LZ4" );
+#ifdef GRN_OBJ_COMPRESS_ZSTD
+    lstate_str2arr( L, GRN_OBJ_COMPRESS_ZSTD >> 4, "ZSTD" );
+#endif
     REF_I2N_COMPRESS = lstate_ref( L );
+    
+    
+    // output types
+    lua_newtable( L );
+    lstate_int2tbl( L, "JSON", GRN_CONTENT_JSON );
+    lstate_int2tbl( L, "XML", GRN_CONTENT_XML );
+    lstate_int2tbl( L, "TSV", GRN_CONTENT_TSV );
+    lstate_int2tbl( L, "MSGPACK", GRN_CONTENT_MSGPACK );
+#ifdef GRN_VERSION_OR_LATER
+#if GRN_VERSION_OR_LATER( 9, 0, 2 )
+    lstate_int2tbl( L, "APACHE_ARROW", GRN_CONTENT_APACHE_ARROW );
+#endif
+#endif
+    REF_N2I_OUTPUT = lstate_ref( L );
 }
 
 
@@ -0,0 +1,598 @@
+/*
+ *  Copyright 2015 Masatoshi Teruya. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a 
+ *  copy of this software and associated documentation files (the "Software"), 
+ *  to deal in the Software without restriction, including without limitation 
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ *  and/or sell copies of the Software, and to permit persons to whom the 
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL 
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ *  files.c
+ *  lua-groonga
+ *
+ */
+
+#include "lgroonga.h"
+#include <stdio.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/syscall.h>
+#endif
+
+
+// MARK: file lookup
+
+// add the entries of dir that named as "<path>.<suffix>" to the table at 
+// files. object paths are listed in the keys of table at idx.
+static int scan_dir( lua_State *L, int idx, int files, const char *dir )
+{
+    DIR *dp = opendir( dir );
+    struct dirent *entry = NULL;
+    const char *name = NULL;
+    const char *dot = NULL;
+    int found = 0;
+    
+    if( !dp ){
+        return -1;
+    }
+    
+    while( ( entry = readdir( dp ) ) )
+    {
+        name = entry->d_name;
+        // lookup each prefix that ends before a period from object paths
+        for( dot = name; ( dot = strchr( dot, '.' ) ); dot++ )
+        {
+            if( dot == name || !dot[1] ){
+                continue;
+            }
+            lua_pushstring( L, dir );
+            lua_pushlstring( L, name, (size_t)( dot - name ) );
+            lua_concat( L, 2 );
+            lua_rawget( L, idx );
+            found = lua_toboolean( L, -1 );
+            lua_pop( L, 1 );
+            if( found ){
+                lua_pushstring( L, dir );
+                lua_pushstring( L, name );
+                lua_concat( L, 2 );
+                lua_pushboolean( L, 1 );
+                lua_rawset( L, files );
+                break;
+            }
+        }
+    }
+    
+    closedir( dp );
+    
+    return 0;
+}
+
+
+// collect files of the object paths and files that named as 
+// "<path>.<suffix>". groonga splits objects into the files such as 
+// "<path>.001" and "<path>.c". each directory is scanned only once.
+int lgrn_files_collectv( lua_State *L, int idx )
+{
+    int files = lua_gettop( L );
+    int dirs = files + 1;
+    const char *path = NULL;
+    const char *base = NULL;
+    struct stat st;
+    
+    if( idx < 0 ){
+        idx = files + idx + 1;
+    }
+    
+    lua_newtable( L );
+    lua_pushnil( L );
+    while( lua_next( L, idx ) )
+    {
+        lua_pop( L, 1 );
+        path = lua_tostring( L, -1 );
+        if( !( base = strrchr( path, '/' ) ) ){
+            lua_settop( L, files );
+            errno = EINVAL;
+            return -1;
+        }
+        // path itself
+        else if( stat( path, &st ) == 0 && S_ISREG( st.st_mode ) ){
+            lua_pushvalue( L, -1 );
+            lua_pushboolean( L, 1 );
+            lua_rawset( L, files );
+        }
+        // directory of path
+        lua_pushlstring( L, path, (size_t)( base - path ) + 1 );
+        lua_pushboolean( L, 1 );
+        lua_rawset( L, dirs );
+    }
+    
+    lua_pushnil( L );
+    while( lua_next( L, dirs ) )
+    {
+        lua_pop( L, 1 );
+        if( scan_dir( L, idx, files, lua_tostring( L, -1 ) ) != 0 ){
+            lua_settop( L, files );
+            return -1;
+        }
+    }
+    lua_settop( L, files );
+    
+    return 0;
+}
+
+
+int lgrn_files_collect( lua_State *L, const char *path )
+{
+    int rc = 0;
+    
+    lua_newtable( L );
+    lua_pushstring( L, path );
+    lua_pushboolean( L, 1 );
+    lua_rawset( L, -3 );
+    lua_insert( L, -2 );
+    rc = lgrn_files_collectv( L, -2 );
+    lua_remove( L, -2 );
+    
+    return rc;
+}
+
+
+int lgrn_files_usage( lua_State *L, int idx, size_t *nbytes )
+{
+    struct stat st;
+    
+    *nbytes = 0;
+    lua_pushnil( L );
+    while( lua_next( L, idx ) )
+    {
+        lua_pop( L, 1 );
+        if( stat( lua_tostring( L, -1 ), &st ) == 0 ){
+            *nbytes += (size_t)st.st_blocks * 512;
+        }
+        // ignore the file that removed after lookup
+        else if( errno != ENOENT ){
+            lua_pop( L, 1 );
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+
+// MARK: prewarm
+
+typedef struct {
+    void *addr;
+    size_t len;
+} pin_t;
+
+struct lgrn_pins_st {
+    size_t npins;
+    pin_t pins[];
+};
+
+
+typedef struct {
+    const char **files;
+    size_t nfiles;
+    size_t next;
+    size_t nbytes;
+    int mode;
+    int err;
+    lgrn_pins_t *pins;
+    pthread_mutex_t mutex;
+} prewarm_t;
+
+
+static int prewarm_file( const char *path, int mode, size_t *nbytes, 
+                         pin_t *pin )
+{
+    int fd = open( path, O_RDONLY );
+    struct stat st;
+    
+    if( fd == -1 ){
+        return -1;
+    }
+    else if( fstat( fd, &st ) == -1 ){
+        close( fd );
+        return -1;
+    }
+    else if( st.st_size > 0 )
+    {
+        size_t len = (size_t)st.st_size;
+        
+        if( mode == LGRN_PREWARM_WILLNEED )
+        {
+            // ask the kernel to read ahead asynchronously
+            if( ( errno = posix_fadvise( fd, 0, 0, POSIX_FADV_WILLNEED ) ) ){
+                close( fd );
+                return -1;
+            }
+        }
+        else
+        {
+            long pagesize = sysconf( _SC_PAGESIZE );
+            volatile uint8_t sum = 0;
+            uint8_t *addr = mmap( NULL, len, PROT_READ, MAP_SHARED, fd, 0 );
+            size_t pos = 0;
+            
+            if( addr == MAP_FAILED ){
+                close( fd );
+                return -1;
+            }
+            // fault in and pin the pages until unpinned
+            else if( mode == LGRN_PREWARM_LOCK ){
+                if( mlock( addr, len ) == -1 ){
+                    munmap( addr, len );
+                    close( fd );
+                    return -1;
+                }
+                pin->addr = addr;
+                pin->len = len;
+            }
+            // read a byte of each page to fault in
+            else {
+                madvise( addr, len, MADV_WILLNEED );
+                for(; pos < len; pos += (size_t)pagesize ){
+                    sum += addr[pos];
+                }
+                munmap( addr, len );
+            }
+        }
+        *nbytes += len;
+    }
+    
+    close( fd );
+    
+    return 0;
+}
+
+
+static void *prewarm_worker( void *arg )
+{
+    prewarm_t *p = (prewarm_t*)arg;
+    pin_t *pin = NULL;
+    size_t nbytes = 0;
+    size_t idx = 0;
+    
+    while( 1 )
+    {
+        // pull a next file
+        pthread_mutex_lock( &p->mutex );
+        idx = p->next++;
+        pthread_mutex_unlock( &p->mutex );
+        
+        if( idx >= p->nfiles ){
+            break;
+        }
+        
+        // each file has its own slot
+        pin = p->pins ? &p->pins->pins[idx] : NULL;
+        // ignore the file that removed after lookup
+        if( prewarm_file( p->files[idx], p->mode, &nbytes, pin ) == -1 &&
+            errno != ENOENT ){
+            pthread_mutex_lock( &p->mutex );
+            p->err = errno;
+            pthread_mutex_unlock( &p->mutex );
+        }
+    }
+    
+    pthread_mutex_lock( &p->mutex );
+    p->nbytes += nbytes;
+    pthread_mutex_unlock( &p->mutex );
+    
+    return NULL;
+}
+
+
+void lgrn_files_unpin( lgrn_pins_t *pins )
+{
+    size_t i = 0;
+    
+    if( pins )
+    {
+        // unmapping also unlocks the pages
+        for(; i < pins->npins; i++ ){
+            if( pins->pins[i].addr ){
+                munmap( pins->pins[i].addr, pins->pins[i].len );
+            }
+        }
+        pdealloc( pins );
+    }
+}
+
+
+// prewarm the files that listed in the keys of table at idx
+int lgrn_files_prewarm( lua_State *L, int idx, int mode, int nthreads,
+                        size_t *nfiles, size_t *nbytes, lgrn_pins_t **pins )
+{
+    prewarm_t p = {
+        .files = NULL,
+        .nfiles = 0,
+        .next = 0,
+        .nbytes = 0,
+        .mode = mode,
+        .err = 0,
+        .pins = NULL
+    };
+    pthread_t *tids = NULL;
+    size_t nelts = 0;
+    int i = 0;
+    
+    *pins = NULL;
+    // count files
+    lua_pushnil( L );
+    while( lua_next( L, idx ) ){
+        nelts++;
+        lua_pop( L, 1 );
+    }
+    if( !nelts ){
+        *nfiles = 0;
+        *nbytes = 0;
+        return 0;
+    }
+    else if( !( p.files = malloc( sizeof( const char* ) * nelts ) ) ){
+        return -1;
+    }
+    // slots of pinned mappings
+    else if( mode == LGRN_PREWARM_LOCK )
+    {
+        if( !( p.pins = calloc( 1, sizeof( lgrn_pins_t ) + 
+                                   sizeof( pin_t ) * nelts ) ) ){
+            pdealloc( p.files );
+            return -1;
+        }
+        p.pins->npins = nelts;
+    }
+    
+    // strings are anchored by the table while prewarming
+    lua_pushnil( L );
+    while( lua_next( L, idx ) ){
+        lua_pop( L, 1 );
+        p.files[p.nfiles++] = lua_tostring( L, -1 );
+    }
+    
+    if( nthreads < 1 ){
+        nthreads = 1;
+    }
+    else if( (size_t)nthreads > p.nfiles ){
+        nthreads = (int)p.nfiles;
+    }
+    
+    if( !( tids = malloc( sizeof( pthread_t ) * (size_t)nthreads ) ) ){
+        lgrn_files_unpin( p.pins );
+        pdealloc( p.files );
+        return -1;
+    }
+    pthread_mutex_init( &p.mutex, NULL );
+    
+    // run workers in parallel
+    for(; i < nthreads; i++ )
+    {
+        if( pthread_create( &tids[i], NULL, prewarm_worker, (void*)&p ) ){
+            break;
+        }
+    }
+    // the caller thread also works on the remaining files if could not 
+    // create all threads
+    if( i < nthreads ){
+        prewarm_worker( (void*)&p );
+    }
+    while( i-- > 0 ){
+        pthread_join( tids[i], NULL );
+    }
+    
+    pthread_mutex_destroy( &p.mutex );
+    pdealloc( tids );
+    pdealloc( p.files );
+    
+    *nfiles = p.nfiles;
+    *nbytes = p.nbytes;
+    if( p.err ){
+        lgrn_files_unpin( p.pins );
+        errno = p.err;
+        return -1;
+    }
+    *pins = p.pins;
+    
+    return 0;
+}
+
+
+// MARK: copy
+
+#define COPY_BUFSIZE    (1024 * 1024)
+
+static int copy_buffered( int sfd, int dfd, size_t len )
+{
+    char *buf = malloc( COPY_BUFSIZE );
+    ssize_t rv = 0;
+    ssize_t off = 0;
+    
+    if( !buf ){
+        return -1;
+    }
+    
+    while( len )
+    {
+        rv = read( sfd, buf, len < COPY_BUFSIZE ? len : COPY_BUFSIZE );
+        if( rv == -1 ){
+            if( errno == EINTR ){
+                continue;
+            }
+            pdealloc( buf );
+            return -1;
+        }
+        // file has been truncated
+        else if( rv == 0 ){
+            break;
+        }
+        len -= (size_t)rv;
+        
+        for( off = 0; off < rv; )
+        {
+            ssize_t nw = write( dfd, buf + off, (size_t)( rv - off ) );
+            
+            if( nw == -1 ){
+                if( errno == EINTR ){
+                    continue;
+                }
+                pdealloc( buf );
+                return -1;
+            }
+            off += nw;
+        }
+    }
+    
+    pdealloc( buf );
+    
+    return 0;
+}
+
+
+// copy the contents of sfd to dfd.
+// returns 1 if copied by reflink, 0 if copied by other methods
+static int copy_fd( int sfd, int dfd, size_t len )
+{
+#ifdef FICLONE
+    // share the extents with the source file if filesystem supports it
+    if( ioctl( dfd, FICLONE, sfd ) == 0 ){
+        return 1;
+    }
+#endif
+    
+#ifdef SYS_copy_file_range
+    // copy in the kernel
+    while( len )
+    {
+        ssize_t rv = syscall( SYS_copy_file_range, sfd, NULL, dfd, NULL, 
+                              len, 0 );
+        
+        if( rv == -1 ){
+            if( errno == EINTR ){
+                continue;
+            }
+            // fallback to buffered copy
+            else if( errno == ENOSYS || errno == EXDEV || errno == EINVAL ||
+                     errno == EOPNOTSUPP ){
+                break;
+            }
+            return -1;
+        }
+        // file has been truncated
+        else if( rv == 0 ){
+            return 0;
+        }
+        len -= (size_t)rv;
+    }
+#endif
+    
+    if( len && copy_buffered( sfd, dfd, len ) != 0 ){
+        return -1;
+    }
+    
+    return 0;
+}
+
+
+static int copy_file( const char *src, const char *dst, size_t *nbytes )
+{
+    int sfd = open( src, O_RDONLY );
+    int dfd = -1;
+    struct stat st;
+    int rc = 0;
+    int err = 0;
+    
+    if( sfd == -1 ){
+        return -1;
+    }
+    else if( fstat( sfd, &st ) == -1 ||
+             ( dfd = open( dst, O_WRONLY|O_CREAT|O_EXCL, 
+                           st.st_mode & 0777 ) ) == -1 ){
+        close( sfd );
+        return -1;
+    }
+    
+    rc = copy_fd( sfd, dfd, (size_t)st.st_size );
+    if( rc == -1 || fsync( dfd ) == -1 ){
+        err = errno;
+        close( sfd );
+        close( dfd );
+        // remove an incomplete file
+        unlink( dst );
+        errno = err;
+        return -1;
+    }
+    close( sfd );
+    if( close( dfd ) == -1 ){
+        return -1;
+    }
+    *nbytes += (size_t)st.st_size;
+    
+    return rc;
+}
+
+
+int lgrn_files_copy( lua_State *L, int idx, const char *dest, 
+                     lgrn_copystat_t *stat )
+{
+    size_t dlen = strlen( dest );
+    const char *src = NULL;
+    const char *name = NULL;
+    char *dst = NULL;
+    int rc = 0;
+    
+    *stat = (lgrn_copystat_t){ 0, 0, 0 };
+    if( mkdir( dest, 0777 ) == -1 && errno != EEXIST ){
+        return -1;
+    }
+    
+    lua_pushnil( L );
+    while( lua_next( L, idx ) )
+    {
+        lua_pop( L, 1 );
+        src = lua_tostring( L, -1 );
+        name = strrchr( src, '/' );
+        name = name ? name + 1 : src;
+        
+        if( !( dst = malloc( dlen + strlen( name ) + 2 ) ) ){
+            lua_pop( L, 1 );
+            return -1;
+        }
+        sprintf( dst, "%s/%s", dest, name );
+        rc = copy_file( src, dst, &stat->nbytes );
+        pdealloc( dst );
+        
+        if( rc == -1 ){
+            // ignore the file that removed after lookup
+            if( errno == ENOENT ){
+                continue;
+            }
+            lua_pop( L, 1 );
+            return -1;
+        }
+        stat->nfiles++;
+        stat->ncloned += (size_t)rc;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,231 @@
+/*
+ *  Copyright 2015 Masatoshi Teruya. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a 
+ *  copy of this software and associated documentation files (the "Software"), 
+ *  to deal in the Software without restriction, including without limitation 
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ *  and/or sell copies of the Software, and to permit persons to whom the 
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL 
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ *  flusher.c
+ *  lua-groonga
+ *
+ */
+
+#include "lgroonga.h"
+#include <pthread.h>
+#include <sys/time.h>
+
+
+struct lgrn_flusher_st {
+    pthread_t tid;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    // context for the flusher thread
+    grn_ctx ctx;
+    grn_obj *db;
+    // flush policy
+    uint32_t nwrites;
+    uint32_t interval;
+    // number of writes since last flush
+    uint32_t writes;
+    uint8_t running;
+    // thread has been stopped by lgrn_flusher_suspend
+    uint8_t suspended;
+};
+
+
+static void flush( lgrn_flusher_t *f )
+{
+    f->writes = 0;
+    pthread_mutex_unlock( &f->mutex );
+    grn_obj_flush_recursive( &f->ctx, f->db );
+    pthread_mutex_lock( &f->mutex );
+}
+
+
+static void *flusher_loop( void *arg )
+{
+    lgrn_flusher_t *f = (lgrn_flusher_t*)arg;
+    struct timespec deadline;
+    struct timeval now;
+    int rc = 0;
+    
+    pthread_mutex_lock( &f->mutex );
+    while( f->running )
+    {
+        // number of writes reached to the threshold
+        if( f->nwrites && f->writes >= f->nwrites ){
+            flush( f );
+        }
+        else if( f->interval )
+        {
+            gettimeofday( &now, NULL );
+            deadline.tv_sec = now.tv_sec + f->interval / 1000;
+            deadline.tv_nsec = now.tv_usec * 1000 + 
+                               ( f->interval % 1000 ) * 1000000;
+            if( deadline.tv_nsec >= 1000000000 ){
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000;
+            }
+            
+            rc = pthread_cond_timedwait( &f->cond, &f->mutex, &deadline );
+            // flush pending writes at every interval
+            if( rc == ETIMEDOUT && f->running && f->writes ){
+                flush( f );
+            }
+        }
+        else {
+            pthread_cond_wait( &f->cond, &f->mutex );
+        }
+    }
+    pthread_mutex_unlock( &f->mutex );
+    
+    // flush remaining writes
+    grn_obj_flush_recursive( &f->ctx, f->db );
+    
+    return NULL;
+}
+
+
+// create a context and start the flusher thread
+static int flusher_run( lgrn_flusher_t *f, grn_obj *db )
+{
+    f->db = db;
+    f->running = 1;
+    f->suspended = 0;
+    grn_ctx_init( &f->ctx, 0 );
+    if( grn_ctx_use( &f->ctx, db ) != GRN_SUCCESS ){
+        grn_ctx_fin( &f->ctx );
+        errno = EINVAL;
+        return -1;
+    }
+    pthread_mutex_init( &f->mutex, NULL );
+    pthread_cond_init( &f->cond, NULL );
+    
+    if( ( errno = pthread_create( &f->tid, NULL, flusher_loop, 
+                                  (void*)f ) ) == 0 ){
+        return 0;
+    }
+    
+    pthread_cond_destroy( &f->cond );
+    pthread_mutex_destroy( &f->mutex );
+    grn_ctx_fin( &f->ctx );
+    
+    return -1;
+}
+
+
+// stop the flusher thread and release its context
+static void flusher_halt( lgrn_flusher_t *f )
+{
+    pthread_mutex_lock( &f->mutex );
+    f->running = 0;
+    pthread_cond_signal( &f->cond );
+    pthread_mutex_unlock( &f->mutex );
+    pthread_join( f->tid, NULL );
+    
+    pthread_cond_destroy( &f->cond );
+    pthread_mutex_destroy( &f->mutex );
+    grn_ctx_fin( &f->ctx );
+}
+
+
+lgrn_flusher_t *lgrn_flusher_start( grn_obj *db, uint32_t nwrites, 
+                                    uint32_t interval )
+{
+    lgrn_flusher_t *f = malloc( sizeof( lgrn_flusher_t ) );
+    
+    if( f )
+    {
+        f->nwrites = nwrites;
+        f->interval = interval;
+        f->writes = 0;
+        if( flusher_run( f, db ) == 0 ){
+            return f;
+        }
+        pdealloc( f );
+    }
+    
+    return NULL;
+}
+
+
+void lgrn_flusher_stop( lgrn_flusher_t *f )
+{
+    if( !f->suspended ){
+        flusher_halt( f );
+    }
+    pdealloc( f );
+}
+
+
+// stop the flusher thread before fork. the thread does not exist in the 
+// child process, and the state of mutexes would be undefined if the thread 
+// holds them at fork.
+void lgrn_flusher_suspend( lgrn_flusher_t *f )
+{
+    if( !f->suspended ){
+        flusher_halt( f );
+        f->suspended = 1;
+    }
+}
+
+
+// restart the flusher thread with the same policy after fork
+int lgrn_flusher_resume( lgrn_flusher_t *f, grn_obj *db )
+{
+    if( f->suspended && flusher_run( f, db ) != 0 ){
+        return -1;
+    }
+    
+    return 0;
+}
+
+
+// restart the flusher in the child process. if the flusher has not been 
+// suspended, the thread does not exist in the child process and the state 
+// of mutex is undefined. so, start a new flusher with the same policy and 
+// abandon the inherited one.
+lgrn_flusher_t *lgrn_flusher_postfork( lgrn_flusher_t *f, grn_obj *db )
+{
+    if( !f->suspended ){
+        return lgrn_flusher_start( db, f->nwrites, f->interval );
+    }
+    else if( lgrn_flusher_resume( f, db ) != 0 ){
+        pdealloc( f );
+        return NULL;
+    }
+    
+    return f;
+}
+
+
+void lgrn_flusher_wrote( lgrn_flusher_t *f )
+{
+    // count without lock while the thread is stopped. the writes are 
+    // flushed after lgrn_flusher_resume
+    if( f->suspended ){
+        f->writes++;
+        return;
+    }
+    pthread_mutex_lock( &f->mutex );
+    f->writes++;
+    // wake up the flusher thread
+    if( f->nwrites && f->writes >= f->nwrites ){
+        pthread_cond_signal( &f->cond );
+    }
+    pthread_mutex_unlock( &f->mutex );
+}
@@ -48,370 +48,1566 @@
 #define CHECK_EXISTS( L, g ) \
     CHECK_EXISTS_EX( L, g, CHECK_RET_NIL )
 
+#define CHECK_WRITABLE_EX( L, g, CHECK_RET ) do{ \
+    if( (g)->readonly ){ \
+        CHECK_RET; \
+        lua_pushstring( L, LGRN_EREADONLY ); \
+        return 2; \
+    } \
+}while(0)
 
+#define CHECK_WRITABLE( L, g ) \
+    CHECK_WRITABLE_EX( L, g, CHECK_RET_NIL )
 
-// MARK: table iterator
-
-#define ITERATOR_MT "groonga.table.iterator"
 
-typedef struct {
-    grn_ctx *ctx;
-    grn_table_cursor *cur;
-} tbl_iter_t;
 
+// MARK: schema catalog
 
-// init table lookup iterator
-static grn_rc tbl_iter_init( tbl_iter_t *it, grn_ctx *ctx )
+// push a catalog of tables that contains the following fields;
+//  [0]:      number of tables
+//  [1..n]:   table names
+//  [name]:   table id
+// each object is opened once to check whether it is a table when the 
+// catalog is created, and the catalog is cached until the schema changed.
+static grn_rc catalog_push( lua_State *L, lgrn_t *g )
 {
-    if( ( it->cur = grn_table_cursor_open( ctx, grn_ctx_db( ctx ), NULL, 0, 
-                                           NULL, 0, 0, -1, 0 ) ) ){
-        it->ctx = ctx;
+    grn_ctx *ctx = lgrn_get_ctx( g );
+    grn_table_cursor *cur = NULL;
+    grn_obj *obj = NULL;
+    grn_id id = GRN_ID_NIL;
+    void *key = NULL;
+    int len = 0;
+    int istbl = 0;
+    int n = 0;
+    
+    // schema has not been changed since created
+    if( g->ref_catalog != LUA_NOREF && g->catalog_gen == g->gen ){
+        lstate_pushref( L, g->ref_catalog );
         return GRN_SUCCESS;
     }
+    else if( !( cur = grn_table_cursor_open( ctx, lgrn_get_db( g ), NULL, 0, 
+                                             NULL, 0, 0, -1, 0 ) ) ){
+        return ctx->rc;
+    }
+    
+    lua_newtable( L );
+    while( ( id = grn_table_cursor_next( ctx, cur ) ) != GRN_ID_NIL )
+    {
+        // builtin objects
+        if( id < GRN_N_RESERVED_TYPES ){
+            continue;
+        }
+        
+        // column names are qualified by the table name. so, the object that 
+        // contains a period in the name is not a table.
+        len = grn_table_cursor_get_key( ctx, cur, &key );
+        if( len <= 0 || memchr( key, '.', (size_t)len ) ){
+            continue;
+        }
+        // skip the objects that are not table such as procedures
+        else if( !( obj = grn_ctx_at( ctx, id ) ) ){
+            continue;
+        }
+        istbl = lgrn_obj_istbl( obj );
+        grn_obj_unlink( ctx, obj );
+        if( !istbl ){
+            continue;
+        }
+        
+        n++;
+        lua_pushlstring( L, (const char*)key, (size_t)len );
+        lua_pushvalue( L, -1 );
+        lua_rawseti( L, -3, n );
+        lua_pushinteger( L, id );
+        lua_rawset( L, -3 );
+    }
+    grn_table_cursor_close( ctx, cur );
+    lstate_int2arr( L, 0, n );
     
-    return ctx->rc;
+    // save catalog
+    lstate_unref( L, g->ref_catalog );
+    g->ref_catalog = lstate_refat( L, -1 );
+    g->catalog_gen = g->gen;
+    
+    return GRN_SUCCESS;
 }
 
 
-static grn_rc tbl_iter_dispose( tbl_iter_t *it )
+// MARK: table API
+
+int lgrn_table_push( lua_State *L, lgrn_t *g, int gidx, grn_id id )
 {
-    if( it->cur ){
-        grn_rc rc = grn_table_cursor_close( it->ctx, it->cur );
-        it->cur = NULL;
-        return rc;
+    grn_ctx *ctx = lgrn_get_ctx( g );
+    grn_obj *tbl = NULL;
+    lgrn_tbl_t *t = NULL;
+    
+    // lookup from object reference
+    if( lgrn_refget_obj( L, g, id, GROONGA_TABLE_MT ) ){
+        return 1;
+    }
+    else if( !( tbl = grn_ctx_at( ctx, id ) ) ){
+        return 0;
+    }
+    // not table
+    else if( !lgrn_obj_istbl( tbl ) ){
+        grn_obj_unlink( ctx, tbl );
+        return 0;
+    }
+    // create table metatable
+    else if( ( t = lua_newuserdata( L, sizeof( lgrn_tbl_t ) ) ) ){
+        lstate_setmetatable( L, GROONGA_TABLE_MT );
+        // save reference
+        lgrn_refset_obj( L, g, id, -1 );
+        // init fields
+        lgrn_tbl_init( t, g, tbl, lstate_refat( L, gidx ) );
+        return 1;
     }
     
-    return GRN_SUCCESS;
+    // nomem error
+    grn_obj_unlink( ctx, tbl );
+    
+    return -1;
 }
 
 
-// lookup a next registered table of database
-static grn_rc tbl_iter_next( tbl_iter_t *it, grn_obj **tbl )
+static int get_table( lua_State *L )
 {
-    grn_table_cursor *cur = it->cur;
-    grn_obj *obj = NULL;
-    grn_id id;
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    size_t len = 0;
+    const char *name = NULL;
+    grn_id id = GRN_ID_NIL;
     
-    while( ( id = grn_table_cursor_next( it->ctx, cur ) ) != GRN_ID_NIL )
-    {
-        if( ( obj = grn_ctx_at( it->ctx, id ) ) )
-        {
-            // return table object
-            if( lgrn_obj_istbl( obj ) ){
-                *tbl = obj;
-                return GRN_SUCCESS;
-            }
-            grn_obj_unlink( it->ctx, obj );
-        }
-        else if( it->ctx->rc != GRN_SUCCESS ){
-            return it->ctx->rc;
-        }
+    CHECK_EXISTS( L, g );
+    name = luaL_checklstring( L, 2, &len );
+    
+    // lookup an id without opening object
+    LGRN_PROBE2( resolve__entry, "table", name );
+    if( len > GRN_TABLE_MAX_KEY_SIZE || 
+        !( id = grn_table_get( lgrn_get_ctx( g ), lgrn_get_db( g ), name, 
+                               (unsigned int)len ) ) ){
+        LGRN_PROBE3( resolve__return, "table", name, GRN_ID_NIL );
+        lua_pushnil( L );
+        return 1;
     }
     
-    return GRN_END_OF_DATA;
+    switch( lgrn_table_push( L, g, 1, id ) ){
+        case 1:
+            LGRN_PROBE3( resolve__return, "table", name, id );
+            return 1;
+        // not table
+        case 0:
+            LGRN_PROBE3( resolve__return, "table", name, GRN_ID_NIL );
+            lua_pushnil( L );
+            return 1;
+        // nomem error
+        default:
+            lua_pushnil( L );
+            lua_pushstring( L, strerror( errno ) );
+            return 2;
+    }
 }
 
 
-static int tbl_iter_gc( lua_State *L )
+static int table_lua( lua_State *L )
 {
-    tbl_iter_t *it = lua_touserdata( L, 1 );
-
-    tbl_iter_dispose( it );
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
     
-    return 0;
+    return lgrn_stats_measure( L, g, LGRN_OP_TABLE, get_table( L ) );
 }
 
 
-static void tbl_iter_init_mt( lua_State *L )
+int lgrn_type_opt( lua_State *L, lgrn_t *g, const char *k, grn_obj **type )
 {
-    struct luaL_Reg mmethods[] = {
-        { "__gc", tbl_iter_gc },
-        { NULL, NULL }
-    };
+    grn_ctx *ctx = lgrn_get_ctx( g );
+    lgrn_tbl_t *t = NULL;
+    const char *name = NULL;
+    size_t len = 0;
+    int id = 0;
+    int rc = 0;
+    
+    *type = NULL;
+    lua_pushstring( L, k );
+    lua_gettable( L, -2 );
+    switch( lua_type( L, -1 ) ){
+        case LUA_TNIL:
+        break;
+        
+        case LUA_TSTRING:
+            name = lua_tolstring( L, -1, &len );
+            // builtin data type
+            if( ( id = lgrn_n2i_data( L, name ) ) != -1 ){
+                *type = grn_ctx_at( ctx, (grn_id)id );
+            }
+            // table name
+            else if( len <= GRN_TABLE_MAX_KEY_SIZE &&
+                     ( *type = grn_ctx_get( ctx, name, (int)len ) ) &&
+                     !lgrn_obj_istbl( *type ) ){
+                grn_obj_unlink( ctx, *type );
+                *type = NULL;
+            }
+            rc = *type ? 0 : -1;
+        break;
+        
+        case LUA_TUSERDATA:
+            rc = -1;
+            // table object of same database
+            if( lua_getmetatable( L, -1 ) )
+            {
+                luaL_getmetatable( L, GROONGA_TABLE_MT );
+                if( lua_rawequal( L, -1, -2 ) && 
+                    ( t = lua_touserdata( L, -3 ) )->g == g && 
+                    !t->removed ){
+                    *type = t->tbl;
+                    rc = 0;
+                }
+                lua_pop( L, 2 );
+            }
+        break;
+        
+        default:
+            rc = -1;
+    }
+    lua_pop( L, 1 );
     
-    lgrn_register_mt( L, ITERATOR_MT, mmethods, NULL );
+    return rc;
 }
 
 
-// MARK: table API
-
-static int table_lua( lua_State *L )
+void lgrn_type_push( lua_State *L, lgrn_t *g, grn_id id )
 {
-    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
-    grn_ctx *ctx = NULL;
+    grn_ctx *ctx = lgrn_get_ctx( g );
     size_t len = 0;
-    const char *name = NULL;
-    grn_obj *tbl = NULL;
-    lgrn_tbl_t *t = NULL;
-    
-    CHECK_EXISTS( L, g );
-    name = luaL_checklstring( L, 2, &len );
-    ctx = lgrn_get_ctx( g );
+    const char *name = lgrn_i2n_data( L, (int)id, &len );
+    grn_obj *obj = NULL;
+    lgrn_objname_t oname;
     
-    if( len > GRN_TABLE_MAX_KEY_SIZE || 
-        !( tbl = grn_ctx_get( ctx, name, (int)len ) ) ){
+    if( name ){
+        lua_pushlstring( L, name, len );
+    }
+    // referenced table
+    else if( ( obj = grn_ctx_at( ctx, id ) ) && lgrn_obj_istbl( obj ) && 
+             lgrn_get_objname( &oname, ctx, obj ) ){
+        lua_pushlstring( L, oname.name, (size_t)oname.len );
+    }
+    else {
         lua_pushnil( L );
-        return 1;
+    }
+}
+
+
+// retarget a reusable table object to the table of id.
+// returns 0 if object is not a table.
+static int retarget_table( lua_State *L, lgrn_t *g, lgrn_tbl_t *t, grn_id id )
+{
+    grn_ctx *ctx = lgrn_get_ctx( g );
+    grn_obj *tbl = grn_ctx_at( ctx, id );
+    
+    if( !tbl ){
+        return 0;
     }
     // not table
     else if( !lgrn_obj_istbl( tbl ) ){
         grn_obj_unlink( ctx, tbl );
-        lua_pushnil( L );
-        return 1;
-    }
-    // lookup from weak reference
-    else if( lgrn_refget_tbl( L, name, len ) ){
-        grn_obj_unlink( ctx, tbl );
-        return 1;
+        return 0;
     }
-    // create table metatable
-    else if( ( t = lua_newuserdata( L, sizeof( lgrn_tbl_t ) ) ) ){
-        lstate_setmetatable( L, GROONGA_TABLE_MT );
-        // save reference
-        lgrn_refset_tbl( L, name, len, -1 );
-        // init fields
-        lgrn_tbl_init( t, g, tbl, lstate_refat( L, 1 ) );
-        return 1;
+    
+    // release previous target
+    if( t->tbl && !t->removed ){
+        grn_obj_unlink( ctx, t->tbl );
     }
-
-    // nomem error
-    grn_obj_unlink( ctx, tbl );
-    lua_pushnil( L );
-    lua_pushstring( L, strerror( errno ) );
+    lstate_unref( L, t->ref_cols );
+    lstate_unref( L, t->ref_catalog );
+    lgrn_tbl_init( t, g, tbl, t->ref_g );
+    t->light = 1;
     
-    return 2;
+    return 1;
 }
 
 
 static int tables_next_lua( lua_State *L )
 {
     lgrn_t *g = luaL_checkudata( L, lua_upvalueindex( 1 ), MODULE_MT );
-    int with_obj = lua_toboolean( L, lua_upvalueindex( 2 ) );
-    tbl_iter_t *it = lua_touserdata( L, lua_upvalueindex( 3 ) );
-    int rv = 0;
+    int mode = (int)lua_tointeger( L, lua_upvalueindex( 2 ) );
+    int catalog = lua_upvalueindex( 3 );
+    int idx = (int)lua_tointeger( L, lua_upvalueindex( 4 ) );
+    int n = 0;
+    grn_id id = GRN_ID_NIL;
     
+    LGRN_PROBE2( iter__next, "tables", idx );
     if( IS_REMOVED( g ) ){
         lua_pushnil( L );
         lua_pushstring( L, LGRN_ENODB );
-        rv = 2;
+        return 2;
     }
-    else
+    
+    lua_rawgeti( L, catalog, 0 );
+    n = (int)lua_tointeger( L, -1 );
+    lua_pop( L, 1 );
+    
+    while( idx < n )
     {
-        lgrn_tbl_t *t = NULL;
-        grn_obj *tbl = NULL;
-        lgrn_objname_t oname;
+        // update index
+        idx++;
+        lua_pushinteger( L, idx );
+        lua_replace( L, lua_upvalueindex( 4 ) );
+        
+        // push table name
+        lua_rawgeti( L, catalog, idx );
+        // return name
+        if( mode == LGRN_ITER_NAME ){
+            return 1;
+        }
+        
+        // get table id
+        lua_pushvalue( L, -1 );
+        lua_rawget( L, catalog );
+        // return name and id
+        if( mode == LGRN_ITER_ID ){
+            return 2;
+        }
         
-        while( tbl_iter_next( it, &tbl ) == GRN_SUCCESS )
+        id = (grn_id)lua_tointeger( L, -1 );
+        lua_pop( L, 1 );
+        if( mode == LGRN_ITER_LIGHT )
         {
-            // get table name
-            lgrn_get_objname( &oname, it->ctx, tbl );
-            lua_pushlstring( L, oname.name, (size_t)oname.len );
-            
-            // return name
-            if( !with_obj ){
-                return 1;
-            }
-            // lookup from weak reference
-            else if( lgrn_refget_tbl( L, oname.name, (size_t)oname.len ) ){
-                grn_obj_unlink( it->ctx, tbl );
+            // use the cached object if exists
+            if( lgrn_refget_obj( L, g, id, GROONGA_TABLE_MT ) ){
                 return 2;
             }
-            // create table metatable
-            else if( ( t = lua_newuserdata( L, sizeof( lgrn_tbl_t ) ) ) ){
-                lstate_setmetatable( L, GROONGA_TABLE_MT );
-                // save reference
-                lgrn_refset_tbl( L, oname.name, (size_t)oname.len, -1 );
-                // init fields
-                lgrn_tbl_init( 
-                    t, g, tbl, lstate_refat( L, lua_upvalueindex( 1 ) ) 
-                );
-                
+            else if( retarget_table( L, g, 
+                                     lua_touserdata( L, lua_upvalueindex( 5 ) ),
+                                     id ) ){
+                lua_pushvalue( L, lua_upvalueindex( 5 ) );
                 return 2;
             }
-            
+            // table has been removed
+            lua_pop( L, 1 );
+            continue;
+        }
+        
+        switch( lgrn_table_push( L, g, lua_upvalueindex( 1 ), id ) ){
+            case 1:
+                return 2;
+            // table has been removed
+            case 0:
+                lua_pop( L, 1 );
+                break;
             // nomem error
-            grn_obj_unlink( it->ctx, tbl );
-            lua_pushnil( L );
-            lua_pushstring( L, strerror( errno ) );
-            rv = 2;
+            default:
+                lua_pushnil( L );
+                lua_pushstring( L, strerror( errno ) );
+                return 2;
         }
     }
     
-    tbl_iter_dispose( it );
+    LGRN_PROBE2( iter__return, "tables", idx );
     
-    return rv;
+    return 0;
 }
 
 
 static int tables_lua( lua_State *L )
 {
     lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
-    grn_ctx *ctx = lgrn_get_ctx( g );
-    int with_obj = 0;
-    tbl_iter_t *it = NULL;
+    int mode = lgrn_iter_mode( L, 2 );
     
     CHECK_EXISTS( L, g );
-    ctx = lgrn_get_ctx( g );
-        
+    
     // check argument
-    if( lua_type( L, 2 ) == LUA_TBOOLEAN ){
-        with_obj = lua_toboolean( L, 2 );
+    if( mode == -1 ){
+        return luaL_argerror( L, 2, "invalid mode value" );
     }
     // remove unused stack items
     lua_settop( L, 1 );
-    lua_pushboolean( L, with_obj );
+    lua_pushinteger( L, mode );
     
-    // nomem
-    if( !( it = lua_newuserdata( L, sizeof( tbl_iter_t ) ) ) ){
+    // groonga error
+    if( catalog_push( L, g ) != GRN_SUCCESS ){
         lua_pushnil( L );
-        lua_pushstring( L, strerror( errno ) );
+        lua_pushstring( L, lgrn_get_ctx( g )->errbuf );
         return 2;
     }
-    // groonga error
-    else if( tbl_iter_init( it, ctx ) != GRN_SUCCESS ){
+    lua_pushinteger( L, 0 );
+    LGRN_PROBE2( iter__entry, "tables", mode );
+    
+    // reusable table object that is not cached by the object reference
+    if( mode == LGRN_ITER_LIGHT )
+    {
+        lgrn_tbl_t *t = lua_newuserdata( L, sizeof( lgrn_tbl_t ) );
+        
+        if( !t ){
+            lua_pushnil( L );
+            lua_pushstring( L, strerror( errno ) );
+            return 2;
+        }
+        lstate_setmetatable( L, GROONGA_TABLE_MT );
+        *t = (lgrn_tbl_t){
+            .g = g,
+            .tbl = NULL,
+            .id = GRN_ID_NIL,
+            .removed = 1,
+            .light = 1,
+            .ref_g = lstate_refat( L, 1 ),
+            .ref_cols = LUA_NOREF,
+            .ref_catalog = LUA_NOREF
+        };
+        // upvalues: g, mode, catalog, index, tbl
+        lua_pushcclosure( L, tables_next_lua, 5 );
+    }
+    else {
+        // upvalues: g, mode, catalog, index
+        lua_pushcclosure( L, tables_next_lua, 4 );
+    }
+    
+    return 1;
+}
+
+
+// MARK: command API
+
+// get the outputType option of the options table at the top of stack
+static grn_content_type check_output_type( lua_State *L, int arg )
+{
+    const char *name = lstate_toptstring( L, "outputType", NULL );
+    int id = 0;
+    
+    if( !name ){
+        return GRN_CONTENT_JSON;
+    }
+    else if( ( id = lgrn_n2i_output( L, name ) ) == -1 ){
+        return luaL_argerror( L, arg, "invalid outputType value" );
+    }
+    
+    return (grn_content_type)id;
+}
+
+
+static int execute_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    size_t len = 0;
+    const char *cmd = NULL;
+    grn_content_type otype = GRN_CONTENT_JSON;
+    int readonly = 0;
+    int fnidx = 0;
+    int rv = 0;
+    
+    CHECK_EXISTS( L, g );
+    cmd = luaL_checklstring( L, 2, &len );
+    
+    // check arguments
+    if( !lua_isnoneornil( L, 3 ) )
+    {
+        lua_settop( L, 3 );
+        luaL_checktype( L, 3, LUA_TTABLE );
+        // outputType
+        otype = check_output_type( L, 3 );
+        // onChunk
+        if( lstate_tchecktype( L, "onChunk", LUA_TFUNCTION, 1 ) == 
+            LUA_TFUNCTION ){
+            fnidx = lua_gettop( L );
+        }
+    }
+    
+    if( !( readonly = lgrn_cmd_isreadonly( cmd, len ) ) ){
+        CHECK_WRITABLE( L, g );
+    }
+    
+    rv = lgrn_cmd_exec( L, g, cmd, len, otype, fnidx );
+    // invalidate schema caches only if command may change the schema
+    if( lgrn_cmd_isschema( cmd, len ) ){
+        lgrn_schema_changed( g );
+        lgrn_refsweep_obj( L, g, 0 );
+    }
+    else if( !readonly ){
+        lgrn_wrote( g );
+    }
+    
+    if( rv == -1 ){
+        lua_pushnil( L );
+        lua_insert( L, -2 );
+        return 2;
+    }
+    else if( fnidx ){
+        lua_pushboolean( L, 1 );
+    }
+    
+    return 1;
+}
+
+
+static int execute_batch_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    grn_content_type otype = GRN_CONTENT_JSON;
+    int stop = 1;
+    int changed = 0;
+    int wrote = 0;
+    int nfail = 0;
+    int n = 0;
+    int i = 0;
+    
+    CHECK_EXISTS( L, g );
+    luaL_checktype( L, 2, LUA_TTABLE );
+    
+    // check arguments
+    if( !lua_isnoneornil( L, 3 ) ){
+        lua_settop( L, 3 );
+        luaL_checktype( L, 3, LUA_TTABLE );
+        otype = check_output_type( L, 3 );
+        stop = lstate_toptboolean( L, "stopOnError", 1 );
+    }
+    lua_settop( L, 2 );
+    
+    // count commands. all commands must be strings
+    while( 1 )
+    {
+        lua_rawgeti( L, 2, n + 1 );
+        if( lua_isnil( L, -1 ) ){
+            lua_pop( L, 1 );
+            break;
+        }
+        else if( lua_type( L, -1 ) != LUA_TSTRING ){
+            lstate_argerror( L, 2, "command#%d must be string", n + 1 );
+        }
+        lua_pop( L, 1 );
+        n++;
+    }
+    
+    // outputs and errors
+    lua_createtable( L, n, 0 );
+    lua_newtable( L );
+    for( i = 1; i <= n; i++ )
+    {
+        size_t len = 0;
+        const char *cmd = NULL;
+        int readonly = 0;
+        int rv = 0;
+        
+        // command string is anchored by the argument table
+        lua_rawgeti( L, 2, i );
+        cmd = lua_tolstring( L, -1, &len );
+        lua_pop( L, 1 );
+        
+        if( !( readonly = lgrn_cmd_isreadonly( cmd, len ) ) && g->readonly ){
+            lua_pushstring( L, LGRN_EREADONLY );
+            rv = -1;
+        }
+        else {
+            changed |= lgrn_cmd_isschema( cmd, len );
+            wrote |= !readonly;
+            rv = lgrn_cmd_exec( L, g, cmd, len, otype, 0 );
+        }
+        
+        if( rv == 0 ){
+            lua_rawseti( L, 3, i );
+            continue;
+        }
+        
+        // set false to output and an error message to errors
+        nfail++;
+        lua_rawseti( L, 4, i );
+        lua_pushboolean( L, 0 );
+        lua_rawseti( L, 3, i );
+        if( stop ){
+            break;
+        }
+    }
+    
+    // commands may change the schema
+    if( changed ){
+        lgrn_schema_changed( g );
+        lgrn_refsweep_obj( L, g, 0 );
+    }
+    else if( wrote ){
+        lgrn_wrote( g );
+    }
+    
+    if( !nfail ){
+        lua_pop( L, 1 );
+        return 1;
+    }
+    
+    return 2;
+}
+
+
+// get a procedure object of type
+static grn_obj *proc_get( grn_ctx *ctx, const char *name, size_t len, 
+                          grn_proc_type type )
+{
+    grn_obj *proc = NULL;
+    
+    if( len <= GRN_TABLE_MAX_KEY_SIZE && 
+        ( proc = grn_ctx_get( ctx, name, (int)len ) ) )
+    {
+        if( proc->header.type == GRN_PROC && 
+            grn_proc_get_type( ctx, proc ) == type ){
+            return proc;
+        }
+        grn_obj_unlink( ctx, proc );
+    }
+    
+    return NULL;
+}
+
+
+// set token filters that listed in the array at the top of stack to tbl, 
+// or check the array only if tbl is NULL. returns -1 if the array contains 
+// a name that is not a token filter.
+static int token_filters_set( lua_State *L, grn_ctx *ctx, grn_obj *tbl )
+{
+    grn_obj filters;
+    grn_obj *proc = NULL;
+    const char *name = NULL;
+    size_t len = 0;
+    int i = 1;
+    
+    GRN_PTR_INIT( &filters, GRN_OBJ_VECTOR, GRN_ID_NIL );
+    for(;; i++ )
+    {
+        lua_rawgeti( L, -1, i );
+        if( lua_isnil( L, -1 ) ){
+            lua_pop( L, 1 );
+            break;
+        }
+        else if( !( name = lua_tolstring( L, -1, &len ) ) ||
+                 !( proc = proc_get( ctx, name, len, 
+                                     GRN_PROC_TOKEN_FILTER ) ) ){
+            lua_pop( L, 1 );
+            GRN_OBJ_FIN( ctx, &filters );
+            return -1;
+        }
+        lua_pop( L, 1 );
+        GRN_PTR_PUT( ctx, &filters, proc );
+    }
+    
+    if( tbl ){
+        grn_obj_set_info( ctx, tbl, GRN_INFO_TOKEN_FILTERS, &filters );
+    }
+    GRN_OBJ_FIN( ctx, &filters );
+    
+    return 0;
+}
+
+
+static int create_table( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
+    size_t len = 0;
+    size_t plen = 0;
+    const char *name = NULL;
+    const char *path = NULL;
+    grn_obj *ktype = NULL;
+    grn_obj *vtype = NULL;
+    grn_obj *tokenizer = NULL;
+    grn_obj *normalizer = NULL;
+    int filters = 0;
+    grn_obj_flags flags = 0;
+    grn_obj *tbl = NULL;
+    lgrn_tbl_t *t = NULL;
+    
+    CHECK_EXISTS( L, g );
+    CHECK_WRITABLE( L, g );
+    ctx = lgrn_get_ctx( g );
+    
+    // check arguments
+    if( lua_gettop( L ) > 1 )
+    {
+        int id;
+        
+        lua_settop( L, 2 );
+        luaL_checktype( L, 2, LUA_TTABLE );
+        
+        // path
+        path = lstate_toptstring( L, "path", NULL );
+        
+        // type
+        name = lstate_toptstring( L, "type", NULL );
+        if( name )
+        {
+            id = lgrn_n2i_table( L, name );
+            if( id == -1 ){
+                return luaL_argerror( L, 2, "invalid type value" );
+            }
+            flags |= id;
+        }
+        
+        // keyType
+        if( lgrn_type_opt( L, g, "keyType", &ktype ) == -1 ){
+            return luaL_argerror( L, 2, "invalid keyType value" );
+        }
+        
+        // valType
+        if( lgrn_type_opt( L, g, "valType", &vtype ) == -1 ){
+            return luaL_argerror( L, 2, "invalid valType value" );
+        }
+        
+        // tokenizer
+        name = lstate_toptlstring( L, "tokenizer", NULL, &plen );
+        if( name && !( tokenizer = proc_get( ctx, name, plen, 
+                                             GRN_PROC_TOKENIZER ) ) ){
+            return luaL_argerror( L, 2, "invalid tokenizer value" );
+        }
+        
+        // normalizer
+        name = lstate_toptlstring( L, "normalizer", NULL, &plen );
+        if( name && !( normalizer = proc_get( ctx, name, plen, 
+                                              GRN_PROC_NORMALIZER ) ) ){
+            return luaL_argerror( L, 2, "invalid normalizer value" );
+        }
+        
+        // tokenFilters
+        if( lstate_tchecktype( L, "tokenFilters", LUA_TTABLE, 
+                               1 ) == LUA_TTABLE ){
+            if( token_filters_set( L, ctx, NULL ) == -1 ){
+                return luaL_argerror( L, 2, "invalid tokenFilters value" );
+            }
+            lua_pop( L, 1 );
+            filters = 1;
+        }
+        
+        // name
+        name = lstate_toptlstring( L, "name", NULL, &len );
+        if( len > GRN_TABLE_MAX_KEY_SIZE ){
+            lua_pushnil( L );
+            lua_pushfstring( L, "table name length must be less than %u", 
+                             GRN_TABLE_MAX_KEY_SIZE );
+            return 2;
+        }
+        // set persistent flag automatically if name is not null
+        else if( len || lstate_toptboolean( L, "persistent", 0 ) ){
+            flags |= GRN_OBJ_PERSISTENT;
+        }
+        
+        // withSIS flag
+        if( lstate_toptboolean( L, "withSIS", 0 ) ){
+            flags |= GRN_OBJ_KEY_WITH_SIS;
+        }
+        
+        // normalize flag
+        if( lstate_toptboolean( L, "normalize", 0 ) ){
+            flags |= GRN_OBJ_KEY_NORMALIZE;
+        }
+    }
+
+    // create table metatable
+    if( ( t = lua_newuserdata( L, sizeof( lgrn_tbl_t ) ) ) )
+    {
+        // create table
+        if( ( tbl = grn_table_create( ctx, name, (unsigned int)len, path, 
+                                      flags, ktype, vtype ) ) ){
+            // set lexicon options
+            if( tokenizer ){
+                grn_obj_set_info( ctx, tbl, GRN_INFO_DEFAULT_TOKENIZER, 
+                                  tokenizer );
+            }
+            if( normalizer && ctx->rc == GRN_SUCCESS ){
+                grn_obj_set_info( ctx, tbl, GRN_INFO_NORMALIZER, normalizer );
+            }
+            if( filters && ctx->rc == GRN_SUCCESS ){
+                lua_getfield( L, 2, "tokenFilters" );
+                token_filters_set( L, ctx, tbl );
+                lua_pop( L, 1 );
+            }
+            if( ctx->rc != GRN_SUCCESS ){
+                lua_pushnil( L );
+                lua_pushstring( L, ctx->errbuf );
+                grn_obj_remove( ctx, tbl );
+                return 2;
+            }
+            
+            lgrn_schema_changed( g );
+            lstate_setmetatable( L, GROONGA_TABLE_MT );
+            // save reference
+            lgrn_refset_obj( L, g, grn_obj_id( ctx, tbl ), -1 );
+            // init fields
+            lgrn_tbl_init( t, g, tbl, lstate_refat( L, 1 ) );
+            return 1;
+        }
+        
+        // got error
+        lua_pushnil( L );
+        lua_pushstring( L, ctx->errbuf );
+    }
+    // nomem error
+    else {
+        lua_pushnil( L );
+        lua_pushstring( L, strerror( errno ) );
+    }
+
+    return 2;
+}
+
+
+static int table_create_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    
+    return lgrn_stats_measure( L, g, LGRN_OP_DDL, create_table( L ) );
+}
+
+
+// MARK: database API
+
+static int path_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    
+    CHECK_EXISTS( L, g );
+    lua_pushstring( L, grn_obj_path( lgrn_get_ctx( g ), lgrn_get_db( g ) ) );
+    
+    return 1;
+}
+
+
+static int touch_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    
+    CHECK_EXISTS_EX( L, g, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, g, CHECK_RET_FALSE );
+    grn_db_touch( lgrn_get_ctx( g ), lgrn_get_db( g ) );
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+static int flush_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
+    grn_obj *db = NULL;
+    grn_rc rc = GRN_SUCCESS;
+    int recursive = 1;
+    
+    CHECK_EXISTS_EX( L, g, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, g, CHECK_RET_FALSE );
+    ctx = lgrn_get_ctx( g );
+    db = lgrn_get_db( g );
+    
+    // check arguments
+    if( !lua_isnoneornil( L, 2 ) ){
+        lua_settop( L, 2 );
+        luaL_checktype( L, 2, LUA_TTABLE );
+        recursive = lstate_toptboolean( L, "recursive", 1 );
+    }
+    
+    if( recursive ){
+        rc = lgrn_stats_measure( L, g, LGRN_OP_FLUSH, 
+                                 grn_obj_flush_recursive( ctx, db ) );
+    }
+    else {
+        rc = lgrn_stats_measure( L, g, LGRN_OP_FLUSH, 
+                                 grn_obj_flush( ctx, db ) );
+    }
+    
+    if( rc != GRN_SUCCESS ){
+        lua_pushboolean( L, 0 );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+static int auto_flush_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    lua_Integer nwrites = 0;
+    lua_Integer interval = 0;
+    
+    CHECK_EXISTS_EX( L, g, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, g, CHECK_RET_FALSE );
+    
+    // check arguments
+    if( lua_type( L, 2 ) == LUA_TTABLE )
+    {
+        lua_settop( L, 2 );
+        nwrites = lstate_toptinteger( L, "writes", 0 );
+        interval = lstate_toptinteger( L, "interval", 0 );
+        if( nwrites < 0 || nwrites > UINT32_MAX ){
+            return luaL_argerror( L, 2, "invalid writes value" );
+        }
+        else if( interval < 0 || interval > UINT32_MAX ){
+            return luaL_argerror( L, 2, "invalid interval value" );
+        }
+    }
+    else if( !lua_isnoneornil( L, 2 ) && 
+             !( lua_isboolean( L, 2 ) && !lua_toboolean( L, 2 ) ) ){
+        return luaL_argerror( L, 2, "table or false expected" );
+    }
+    
+    // stop current flusher
+    if( g->flusher ){
+        lgrn_flusher_stop( g->flusher );
+        g->flusher = NULL;
+    }
+    
+    // start flusher
+    if( ( nwrites || interval ) && 
+        !( g->flusher = lgrn_flusher_start( lgrn_get_db( g ), 
+                                            (uint32_t)nwrites, 
+                                            (uint32_t)interval ) ) ){
+        lua_pushboolean( L, 0 );
+        lua_pushstring( L, strerror( errno ) );
+        return 2;
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+// add the paths of object and its columns to the table at the top of stack
+static int collect_paths( lua_State *L, grn_ctx *ctx, grn_obj *obj )
+{
+    const char *path = grn_obj_path( ctx, obj );
+    grn_hash *cols = NULL;
+    grn_hash_cursor *cur = NULL;
+    grn_obj *col = NULL;
+    grn_id *id = NULL;
+    
+    // temporary object
+    if( !path ){
+        return 0;
+    }
+    lua_pushstring( L, path );
+    lua_pushboolean( L, 1 );
+    lua_rawset( L, -3 );
+    
+    if( !lgrn_obj_istbl( obj ) ){
+        return 0;
+    }
+    else if( !( cols = grn_hash_create( ctx, NULL, sizeof( grn_id ), 0, 
+                                        GRN_OBJ_TABLE_HASH_KEY ) ) ){
+        errno = ENOMEM;
+        return -1;
+    }
+    
+    grn_table_columns( ctx, obj, NULL, 0, (grn_obj*)cols );
+    if( ( cur = grn_hash_cursor_open( ctx, cols, NULL, 0, NULL, 0, 0, -1, 
+                                      0 ) ) )
+    {
+        while( grn_hash_cursor_next( ctx, cur ) != GRN_ID_NIL )
+        {
+            grn_hash_cursor_get_key_value( ctx, cur, (void**)&id, NULL, 
+                                           NULL );
+            if( ( col = grn_ctx_at( ctx, *id ) ) )
+            {
+                if( ( path = grn_obj_path( ctx, col ) ) ){
+                    lua_pushstring( L, path );
+                    lua_pushboolean( L, 1 );
+                    lua_rawset( L, -3 );
+                }
+                grn_obj_unlink( ctx, col );
+            }
+        }
+        grn_hash_cursor_close( ctx, cur );
+    }
+    grn_hash_close( ctx, cols );
+    
+    return 0;
+}
+
+
+static int prewarm_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
+    int mode = LGRN_PREWARM_WILLNEED;
+    int nthreads = (int)sysconf( _SC_NPROCESSORS_ONLN );
+    int nobj = 0;
+    size_t nfiles = 0;
+    size_t nbytes = 0;
+    lgrn_pins_t *pins = NULL;
+    
+    CHECK_EXISTS( L, g );
+    ctx = lgrn_get_ctx( g );
+    
+    // create object path list
+    lua_settop( L, 2 );
+    lua_newtable( L );
+    
+    // check arguments
+    if( !lua_isnoneornil( L, 2 ) )
+    {
+        const char *lists[] = { "tables", "columns", NULL };
+        const char **list = NULL;
+        const char *opt = NULL;
+        const char *name = NULL;
+        size_t len = 0;
+        grn_obj *obj = NULL;
+        int istbl = 0;
+        int rc = 0;
+        int i = 1;
+        
+        luaL_checktype( L, 2, LUA_TTABLE );
+        lua_pushvalue( L, 2 );
+        
+        // mode
+        opt = lstate_toptstring( L, "mode", "willneed" );
+        if( strcmp( opt, "willneed" ) == 0 ){
+            mode = LGRN_PREWARM_WILLNEED;
+        }
+        else if( strcmp( opt, "touch" ) == 0 ){
+            mode = LGRN_PREWARM_TOUCH;
+        }
+        else if( strcmp( opt, "lock" ) == 0 ){
+            mode = LGRN_PREWARM_LOCK;
+        }
+        else {
+            return luaL_argerror( L, 2, "invalid mode value" );
+        }
+        
+        // threads
+        nthreads = (int)lstate_toptinteger( L, "threads", nthreads );
+        
+        // tables and columns
+        for( list = lists; *list; list++ )
+        {
+            if( lstate_tchecktype( L, *list, LUA_TTABLE, 1 ) == LUA_TNIL ){
+                continue;
+            }
+            for( i = 1;; i++ )
+            {
+                lua_rawgeti( L, -1, i );
+                if( !( name = lua_tolstring( L, -1, &len ) ) ){
+                    lua_pop( L, 1 );
+                    break;
+                }
+                lua_pop( L, 1 );
+                
+                if( len > GRN_TABLE_MAX_KEY_SIZE ||
+                    !( obj = grn_ctx_get( ctx, name, (int)len ) ) ){
+                    lua_pushnil( L );
+                    lua_pushfstring( L, "%s: %s not found", *list, name );
+                    return 2;
+                }
+                
+                // tables option should contain only table names
+                istbl = lgrn_obj_istbl( obj );
+                if( ( list == lists ) == istbl ){
+                    // move an object path list to the top
+                    lua_pushvalue( L, 3 );
+                    rc = collect_paths( L, ctx, obj );
+                    lua_pop( L, 1 );
+                }
+                grn_obj_unlink( ctx, obj );
+                
+                if( ( list == lists ) != istbl ){
+                    lua_pushnil( L );
+                    lua_pushfstring( L, "%s: %s not found", *list, name );
+                    return 2;
+                }
+                else if( rc != 0 ){
+                    lua_pushnil( L );
+                    lua_pushstring( L, strerror( errno ) );
+                    return 2;
+                }
+                nobj++;
+            }
+            lua_pop( L, 1 );
+        }
+        lua_settop( L, 3 );
+    }
+    
+    // prewarm whole database. files of database objects are named as 
+    // "<db>.<id>", so they are collected with the database path.
+    if( !nobj ){
+        lua_pushvalue( L, 3 );
+        collect_paths( L, ctx, lgrn_get_db( g ) );
+        lua_pop( L, 1 );
+    }
+    
+    // create file list
+    lua_newtable( L );
+    if( lgrn_files_collectv( L, 3 ) != 0 ||
+        lgrn_files_prewarm( L, 4, mode, nthreads, &nfiles, &nbytes, 
+                            &pins ) != 0 ){
+        lua_pushnil( L );
+        lua_pushstring( L, strerror( errno ) );
+        return 2;
+    }
+    // replace the pinned mappings
+    else if( mode == LGRN_PREWARM_LOCK ){
+        lgrn_files_unpin( g->pins );
+        g->pins = pins;
+    }
+    
+    lua_createtable( L, 0, 2 );
+    lstate_int2tbl( L, "files", nfiles );
+    lstate_int2tbl( L, "bytes", nbytes );
+    
+    return 1;
+}
+
+
+// defragment the variable size columns in ascending order of id.
+// if budget is specified, stop at the column that exceeds the budget and 
+// resume from the next column at the next call.
+static int defrag_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    lua_Integer threshold = 0;
+    lua_Integer budget = 0;
+    grn_ctx *ctx = NULL;
+    grn_table_cursor *cur = NULL;
+    grn_obj *col = NULL;
+    grn_id id = GRN_ID_NIL;
+    void *key = NULL;
+    int len = 0;
+    int nsegs = 0;
+    int ncols = 0;
+    int done = 1;
+    uint64_t deadline = 0;
+    
+    CHECK_EXISTS( L, g );
+    CHECK_WRITABLE( L, g );
+    ctx = lgrn_get_ctx( g );
+    
+    // check arguments
+    if( !lua_isnoneornil( L, 2 ) )
+    {
+        lua_settop( L, 2 );
+        luaL_checktype( L, 2, LUA_TTABLE );
+        threshold = lstate_toptinteger( L, "threshold", 0 );
+        budget = lstate_toptinteger( L, "budget", 0 );
+        if( threshold < 0 || threshold > INT32_MAX ){
+            return luaL_argerror( L, 2, "invalid threshold value" );
+        }
+        else if( budget < 0 ){
+            return luaL_argerror( L, 2, "invalid budget value" );
+        }
+    }
+    
+    if( budget ){
+        deadline = lgrn_clock_ns() + (uint64_t)budget * 1000000ULL;
+    }
+    if( !( cur = grn_table_cursor_open( ctx, lgrn_get_db( g ), NULL, 0, 
+                                        NULL, 0, 0, -1, GRN_CURSOR_BY_ID ) ) ){
+        lua_pushnil( L );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    
+    while( ( id = grn_table_cursor_next( ctx, cur ) ) != GRN_ID_NIL )
+    {
+        // builtin objects and columns that defragmented at previous call
+        if( id < GRN_N_RESERVED_TYPES || id <= g->defrag_id ){
+            continue;
+        }
+        
+        // column names are qualified by the table name
+        len = grn_table_cursor_get_key( ctx, cur, &key );
+        if( len <= 0 || !memchr( key, '.', (size_t)len ) ){
+            continue;
+        }
+        else if( ( col = grn_ctx_at( ctx, id ) ) )
+        {
+            if( col->header.type == GRN_COLUMN_VAR_SIZE ){
+                nsegs += grn_obj_defrag( ctx, col, (int)threshold );
+                ncols++;
+            }
+            grn_obj_unlink( ctx, col );
+            // groonga error
+            if( ctx->rc != GRN_SUCCESS ){
+                grn_table_cursor_close( ctx, cur );
+                if( nsegs ){
+                    lgrn_wrote( g );
+                }
+                lua_pushnil( L );
+                lua_pushstring( L, ctx->errbuf );
+                return 2;
+            }
+        }
+        
+        g->defrag_id = id;
+        // exceeded the budget
+        if( deadline && lgrn_clock_ns() >= deadline )
+        {
+            // not done if there is a next column
+            while( ( id = grn_table_cursor_next( ctx, cur ) ) != GRN_ID_NIL )
+            {
+                len = grn_table_cursor_get_key( ctx, cur, &key );
+                if( len > 0 && memchr( key, '.', (size_t)len ) ){
+                    done = 0;
+                    break;
+                }
+            }
+            break;
+        }
+    }
+    grn_table_cursor_close( ctx, cur );
+    
+    // start over at the next call
+    if( done ){
+        g->defrag_id = GRN_ID_NIL;
+    }
+    if( nsegs ){
+        lgrn_wrote( g );
+    }
+    
+    lua_createtable( L, 0, 3 );
+    lstate_int2tbl( L, "segments", nsegs );
+    lstate_int2tbl( L, "columns", ncols );
+    lua_pushliteral( L, "done" );
+    lua_pushboolean( L, done );
+    lua_rawset( L, -3 );
+    
+    return 1;
+}
+
+
+static int lock_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    int timeout = (int)luaL_optinteger( L, 2, grn_get_lock_timeout() );
+    grn_ctx *ctx = NULL;
+    
+    CHECK_EXISTS_EX( L, g, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, g, CHECK_RET_FALSE );
+    ctx = lgrn_get_ctx( g );
+    if( grn_obj_lock( ctx, lgrn_get_db( g ), GRN_ID_NIL, timeout ) != GRN_SUCCESS ){
+        lua_pushboolean( L, 0 );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+static int unlock_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
+    
+    CHECK_EXISTS_EX( L, g, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, g, CHECK_RET_FALSE );
+    ctx = lgrn_get_ctx( g );
+    if( grn_obj_unlock( ctx, lgrn_get_db( g ), GRN_ID_NIL ) != GRN_SUCCESS ){
+        lua_pushboolean( L, 0 );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+static int is_locked_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    
+    CHECK_EXISTS_EX( L, g, CHECK_RET_FALSE );
+    lua_pushboolean( L, grn_obj_is_locked( lgrn_get_ctx( g ), lgrn_get_db( g ) ) );
+    
+    return 1;
+}
+
+
+// force clear a lock
+static int clear_lock_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
+    
+    CHECK_EXISTS_EX( L, g, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, g, CHECK_RET_FALSE );
+    ctx = lgrn_get_ctx( g );
+    if( grn_obj_clear_lock( ctx, lgrn_get_db( g ) ) != GRN_SUCCESS ){
+        lua_pushboolean( L, 0 );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+// clear a lock of database that copied while locked
+static grn_rc snapshot_unlock( const char *dest, const char *path )
+{
+    const char *name = strrchr( path, '/' );
+    char *dbpath = malloc( strlen( dest ) + strlen( path ) + 2 );
+    grn_ctx ctx;
+    grn_obj *db = NULL;
+    grn_rc rc = GRN_SUCCESS;
+    
+    if( !dbpath ){
+        return GRN_NO_MEMORY_AVAILABLE;
+    }
+    sprintf( dbpath, "%s/%s", dest, name ? name + 1 : path );
+    
+    grn_ctx_init( &ctx, 0 );
+    if( ( db = grn_db_open( &ctx, dbpath ) ) ){
+        rc = grn_obj_clear_lock( &ctx, db );
+        grn_obj_close( &ctx, db );
+    }
+    else {
+        rc = ctx.rc;
+    }
+    grn_ctx_fin( &ctx );
+    pdealloc( dbpath );
+    
+    return rc;
+}
+
+
+// collect files of database and copy them into the dest directory.
+// files of tables and columns are named as "<db>.<id>", so they are 
+// collected by a single scan with the database path.
+static int snapshot_copy( lua_State *L, lgrn_t *g, const char *dest, 
+                          lgrn_copystat_t *stat )
+{
+    int top = lua_gettop( L );
+    
+    lua_newtable( L );
+    lua_pushstring( L, grn_obj_path( lgrn_get_ctx( g ), lgrn_get_db( g ) ) );
+    lua_pushboolean( L, 1 );
+    lua_rawset( L, -3 );
+    lua_newtable( L );
+    if( lgrn_files_collectv( L, top + 1 ) != 0 ){
+        return -1;
+    }
+    
+    return lgrn_files_copy( L, top + 2, dest, stat );
+}
+
+
+// copy files of database into the dest directory while locked
+static int snapshot_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    const char *dest = luaL_checkstring( L, 2 );
+    int timeout = (int)luaL_optinteger( L, 3, grn_get_lock_timeout() );
+    grn_ctx *ctx = NULL;
+    grn_obj *db = NULL;
+    lgrn_copystat_t stat;
+    
+    CHECK_EXISTS( L, g );
+    CHECK_WRITABLE( L, g );
+    ctx = lgrn_get_ctx( g );
+    db = lgrn_get_db( g );
+    lua_settop( L, 3 );
+    
+    // temporary database
+    if( !grn_obj_path( ctx, db ) ){
+        lua_pushnil( L );
+        lua_pushstring( L, "temporary database cannot be copied" );
+        return 2;
+    }
+    else if( grn_obj_lock( ctx, db, GRN_ID_NIL, timeout ) != GRN_SUCCESS ){
+        lua_pushnil( L );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    // write the changes to the files
+    else if( grn_obj_flush_recursive( ctx, db ) != GRN_SUCCESS ){
+        lua_pushnil( L );
+        lua_pushstring( L, ctx->errbuf );
+        grn_obj_unlock( ctx, db, GRN_ID_NIL );
+        return 2;
+    }
+    else if( snapshot_copy( L, g, dest, &stat ) != 0 ){
+        lua_pushnil( L );
+        lua_pushstring( L, strerror( errno ) );
+        grn_obj_unlock( ctx, db, GRN_ID_NIL );
+        return 2;
+    }
+    grn_obj_unlock( ctx, db, GRN_ID_NIL );
+    
+    // snapshot should not be locked
+    if( snapshot_unlock( dest, grn_obj_path( ctx, db ) ) != GRN_SUCCESS ){
+        lua_pushnil( L );
+        lua_pushstring( L, "failed to clear a lock of snapshot" );
+        return 2;
+    }
+    
+    lua_createtable( L, 0, 3 );
+    lstate_int2tbl( L, "files", stat.nfiles );
+    lstate_int2tbl( L, "bytes", stat.nbytes );
+    lstate_int2tbl( L, "cloned", stat.ncloned );
+    
+    return 1;
+}
+
+
+static int stats_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    
+    lgrn_stats_push( L, &g->stats );
+    
+    return 1;
+}
+
+
+static int reset_stats_lua( lua_State *L )
+{
+    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    
+    lgrn_stats_reset( &g->stats );
+    
+    return 0;
+}
+
+
+// MARK: memory usage
+
+// returns a number of entries of catalog
+static int catalog_size( lua_State *L, int ref )
+{
+    int n = 0;
+    
+    if( ref != LUA_NOREF ){
+        lstate_pushref( L, ref );
+        lua_rawgeti( L, -1, 0 );
+        n = (int)lua_tointeger( L, -1 );
+        lua_pop( L, 2 );
+    }
+    
+    return n;
+}
+
+
+// returns a number of entries of table
+static int table_size( lua_State *L, int ref )
+{
+    int n = 0;
+    
+    if( ref != LUA_NOREF )
+    {
+        lstate_pushref( L, ref );
         lua_pushnil( L );
-        lua_pushstring( L, ctx->errbuf );
-        return 2;
+        while( lua_next( L, -2 ) ){
+            n++;
+            lua_pop( L, 1 );
+        }
+        lua_pop( L, 1 );
     }
     
-    // set metatable
-    lstate_setmetatable( L, ITERATOR_MT );
-    // upvalues: g, with_obj, it
-    lua_pushcclosure( L, tables_next_lua, 3 );
-    
-    return 1;
+    return n;
 }
 
 
-static int table_create_lua( lua_State *L )
+static int memory_lua( lua_State *L )
 {
     lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
     grn_ctx *ctx = NULL;
-    size_t len = 0;
-    const char *name = NULL;
-    const char *path = NULL;
-    grn_obj *ktype = NULL;
-    grn_obj *vtype = NULL;
-    grn_obj_flags flags = 0;
-    grn_obj *tbl = NULL;
-    lgrn_tbl_t *t = NULL;
+    const char *prefixes[] = { NULL, NULL };
+    lgrn_smaps_t m;
+    int ntbls = 0;
+    int ncols = 0;
+    int ncatalog = 0;
+    int nresolved = 0;
     
     CHECK_EXISTS( L, g );
     ctx = lgrn_get_ctx( g );
     
-    // check arguments
-    if( lua_gettop( L ) > 1 )
+    // temporary database does not have a path
+    prefixes[0] = grn_obj_path( ctx, lgrn_get_db( g ) );
+    if( lgrn_memory_smaps( &m, prefixes[0] ? prefixes : NULL ) == -1 ){
+        lua_pushnil( L );
+        lua_pushstring( L, strerror( errno ) );
+        return 2;
+    }
+    
+    // count live objects and their caches
+    lstate_pushref( L, g->ref_objs );
+    lua_pushnil( L );
+    while( lua_next( L, -2 ) )
     {
-        int id;
-        
-        lua_settop( L, 2 );
-        luaL_checktype( L, 2, LUA_TTABLE );
-        
-        // path
-        path = lstate_toptstring( L, "path", NULL );
-        
-        // type
-        name = lstate_toptstring( L, "type", NULL );
-        if( name )
+        if( lua_getmetatable( L, -1 ) )
         {
-            id = lgrn_n2i_table( L, name );
-            if( id == -1 ){
-                return luaL_argerror( L, 2, "invalid type value" );
+            luaL_getmetatable( L, GROONGA_TABLE_MT );
+            if( lua_rawequal( L, -1, -2 ) ){
+                lgrn_tbl_t *t = lua_touserdata( L, -3 );
+                
+                ntbls++;
+                ncatalog += catalog_size( L, t->ref_catalog );
+                nresolved += table_size( L, t->ref_cols );
             }
-            flags |= id;
-        }
-        
-        // keyType
-        name = lstate_toptstring( L, "keyType", NULL );
-        if( name )
-        {
-            id = lgrn_n2i_data( L, name );
-            if( id == -1 || !( ktype = grn_ctx_at( ctx, (grn_id)id ) ) ){
-                return luaL_argerror( L, 2, "invalid keyType value" );
+            else {
+                ncols++;
             }
+            lua_pop( L, 2 );
         }
+        lua_pop( L, 1 );
+    }
+    lua_pop( L, 1 );
+    
+    lua_createtable( L, 0, 7 );
+    lstate_int2tbl( L, "mapped", (lua_Integer)m.matched );
+    lstate_int2tbl( L, "tables", ntbls );
+    lstate_int2tbl( L, "columns", ncols );
+    lstate_int2tbl( L, "catalog", catalog_size( L, g->ref_catalog ) );
+    lstate_int2tbl( L, "columnCatalogs", ncatalog );
+    lstate_int2tbl( L, "resolved", nresolved );
+#ifdef GRN_VERSION_OR_LATER
+#if GRN_VERSION_OR_LATER( 6, 0, 0 )
+    {
+        grn_table_cursor *cur = grn_table_cursor_open( ctx, lgrn_get_db( g ), 
+                                                       NULL, 0, NULL, 0, 0, -1,
+                                                       GRN_CURSOR_BY_ID );
+        int nopened = 0;
+        grn_id id = GRN_ID_NIL;
         
-        // valType
-        name = lstate_toptstring( L, "valType", NULL );
-        if( name )
+        if( cur )
         {
-            id = lgrn_n2i_data( L, name );
-            if( id == -1 || !( vtype = grn_ctx_at( ctx, (grn_id)id ) ) ){
-                return luaL_argerror( L, 2, "invalid valType value" );
+            while( ( id = grn_table_cursor_next( ctx, cur ) ) != GRN_ID_NIL ){
+                if( grn_ctx_is_opened( ctx, id ) ){
+                    nopened++;
+                }
             }
+            grn_table_cursor_close( ctx, cur );
+            lstate_int2tbl( L, "opened", nopened );
         }
-        
-        // name
-        name = lstate_toptlstring( L, "name", NULL, &len );
-        if( len > GRN_TABLE_MAX_KEY_SIZE ){
-            lua_pushnil( L );
-            lua_pushfstring( L, "table name length must be less than %u", 
-                             GRN_TABLE_MAX_KEY_SIZE );
-            return 2;
-        }
-        // set persistent flag automatically if name is not null
-        else if( len || lstate_toptboolean( L, "persistent", 0 ) ){
-            flags |= GRN_OBJ_PERSISTENT;
-        }
-        
-        // withSIS flag
-        if( lstate_toptboolean( L, "withSIS", 0 ) ){
-            flags |= GRN_OBJ_KEY_WITH_SIS;
-        }
-        
-        // normalize flag
-        if( lstate_toptboolean( L, "normalize", 0 ) ){
-            flags |= GRN_OBJ_KEY_NORMALIZE;
-        }
-    }
-
-    // create table metatable
-    if( ( t = lua_newuserdata( L, sizeof( lgrn_tbl_t ) ) ) )
-    {
-        // create table
-        if( ( tbl = grn_table_create( ctx, name, (unsigned int)len, path, 
-                                      flags, ktype, vtype ) ) ){
-            lstate_setmetatable( L, GROONGA_TABLE_MT );
-            // save reference
-            lgrn_refset_tbl( L, name, len, -1 );
-            // init fields
-            lgrn_tbl_init( t, g, tbl, lstate_refat( L, 1 ) );
-            return 1;
-        }
-        
-        // got error
-        lua_pushnil( L );
-        lua_pushstring( L, ctx->errbuf );
-    }
-    // nomem error
-    else {
-        lua_pushnil( L );
-        lua_pushstring( L, strerror( errno ) );
     }
-
-    return 2;
-}
-
-
-// MARK: database API
-
-static int path_lua( lua_State *L )
-{
-    lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
-    
-    CHECK_EXISTS( L, g );
-    lua_pushstring( L, grn_obj_path( lgrn_get_ctx( g ), lgrn_get_db( g ) ) );
+#endif
+#endif
     
     return 1;
 }
 
 
-static int touch_lua( lua_State *L )
+static int on_slow_lua( lua_State *L )
 {
     lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
+    uint64_t ns = 0;
     
-    CHECK_EXISTS_EX( L, g, CHECK_RET_FALSE );
-    grn_db_touch( lgrn_get_ctx( g ), lgrn_get_db( g ) );
+    if( !lua_isnoneornil( L, 2 ) )
+    {
+        lua_Number msec = luaL_checknumber( L, 2 );
+        
+        luaL_checktype( L, 3, LUA_TFUNCTION );
+        // also reject NaN
+        if( !( msec >= 0 ) ){
+            return luaL_argerror( L, 2, "threshold must be greater than " \
+                                        "or equal to 0" );
+        }
+        // clamp to the maximum value before the conversion
+        else if( msec * 1000000.0 >= (lua_Number)UINT64_MAX ){
+            ns = UINT64_MAX;
+        }
+        // 0 is reserved for disabled
+        else if( !( ns = (uint64_t)( msec * 1000000.0 ) ) ){
+            ns = 1;
+        }
+    }
+    
+    // replace hook
+    lstate_unref( L, g->ref_slow );
+    g->ref_slow = ns ? lstate_refat( L, 3 ) : LUA_NOREF;
+    g->slow_ns = ns;
     lua_pushboolean( L, 1 );
     
     return 1;
@@ -423,6 +1619,13 @@ static int remove_lua( lua_State *L )
     lgrn_t *g = luaL_checkudata( L, 1, MODULE_MT );
     
     CHECK_EXISTS_EX( L, g, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, g, CHECK_RET_FALSE );
+    if( g->flusher ){
+        lgrn_flusher_stop( g->flusher );
+        g->flusher = NULL;
+    }
+    lgrn_files_unpin( g->pins );
+    g->pins = NULL;
     grn_obj_remove( lgrn_get_ctx( g ), lgrn_get_db( g ) );
     g->removed = 1;
     lua_pushboolean( L, 1 );
@@ -431,15 +1634,67 @@ static int remove_lua( lua_State *L )
 }
 
 
+// reinitialize a context that inherited from the parent process.
+// the database object and its mapped files are reused as is, so the
+// database will not be reopened by grn_db_open.
+// temporary tables are owned by the context and closed by grn_ctx_fin, 
+// so their objects are marked as removed.
+static grn_rc postfork( lua_State *L, lgrn_t *g )
+{
+    grn_obj *db = grn_ctx_db( &g->ctx );
+    grn_rc rc = GRN_SUCCESS;
+    
+    lgrn_refsweep_obj( L, g, 1 );
+    grn_ctx_fin( &g->ctx );
+    grn_ctx_init( &g->ctx, 0 );
+    g->pid = getpid();
+    
+    if( ( rc = grn_ctx_use( &g->ctx, db ) ) != GRN_SUCCESS ){
+        return rc;
+    }
+    // restart auto flush
+    else if( g->flusher && 
+             !( g->flusher = lgrn_flusher_postfork( g->flusher, db ) ) ){
+        snprintf( g->ctx.errbuf, sizeof( g->ctx.errbuf ), 
+                  "failed to restart auto flush: %s", strerror( errno ) );
+        return GRN_NO_MEMORY_AVAILABLE;
+    }
+    
+    return GRN_SUCCESS;
+}
+
+
+// restart auto flush that suspended by prefork in the parent process
+static grn_rc resume_flusher( lgrn_t *g )
+{
+    if( g->flusher && 
+        lgrn_flusher_resume( g->flusher, lgrn_get_db( g ) ) != 0 ){
+        snprintf( g->ctx.errbuf, sizeof( g->ctx.errbuf ), 
+                  "failed to restart auto flush: %s", strerror( errno ) );
+        return GRN_NO_MEMORY_AVAILABLE;
+    }
+    
+    return GRN_SUCCESS;
+}
+
+
 static int gc_lua( lua_State *L )
 {
     lgrn_t *g = (lgrn_t*)lua_touserdata( L, 1 );
     
+    // flusher thread does not exist if inherited from the parent process
+    if( g->flusher && g->pid == getpid() ){
+        lgrn_flusher_stop( g->flusher );
+    }
+    lgrn_files_unpin( g->pins );
     if( !g->removed ){
         grn_obj_unlink( &g->ctx, grn_ctx_db( &g->ctx ) );
     }
     // free
     grn_ctx_fin( &g->ctx );
+    lstate_unref( L, g->ref_objs );
+    lstate_unref( L, g->ref_catalog );
+    lstate_unref( L, g->ref_slow );
     
     return 0;
 }
@@ -456,8 +1711,28 @@ static int new_lua( lua_State *L )
     lgrn_t *g = NULL;
     size_t len = 0;
     const char *path = luaL_optlstring( L, 1, NULL, &len );
+    const char *key = NULL;
+    size_t klen = 0;
     char *pathname = NULL;
     int is_relative = 0;
+    int create = 0;
+    int readonly = 0;
+    
+    // check options
+    if( lua_type( L, 2 ) == LUA_TTABLE )
+    {
+        lua_settop( L, 2 );
+        create = lstate_toptboolean( L, "create", 0 );
+        readonly = lstate_toptboolean( L, "readonly", 0 );
+        if( create && readonly ){
+            return luaL_argerror( L, 2, "create option cannot be used " \
+                                        "with readonly option" );
+        }
+    }
+    else if( lua_isboolean( L, 2 ) ){
+        create = lua_toboolean( L, 2 );
+    }
+    lua_settop( L, 1 );
     
     // create temporary db
     if( !path )
@@ -465,10 +1740,10 @@ static int new_lua( lua_State *L )
         // alloc new context
         if( ( g = lua_newuserdata( L, sizeof( lgrn_t ) ) ) )
         {
-            grn_ctx_init( &g->ctx, 0 );
+            lgrn_init( g, readonly );
             if( grn_db_create( &g->ctx, NULL, NULL ) ){
                 lstate_setmetatable( L, MODULE_MT );
-                g->removed = 0;
+                g->ref_objs = lgrn_refnew_obj( L );
                 return 1;
             }
             // got error
@@ -513,11 +1788,31 @@ static int new_lua( lua_State *L )
         path = lua_tolstring( L, -1, &len );
     }
     
+    // read-only database does not share a reference with writable one
+    if( readonly ){
+        lua_pushvalue( L, -1 );
+        lua_pushlstring( L, "\0readonly", 9 );
+        lua_concat( L, 2 );
+        key = lua_tolstring( L, -1, &klen );
+    }
+    else {
+        key = path;
+        klen = len;
+    }
+    
     // lookup from weak reference
-    if( lgrn_refget_db( L, path, len ) )
+    if( lgrn_refget_db( L, key, klen ) )
     {
+        g = (lgrn_t*)lua_touserdata( L, -1 );
         // return reference if there's not removed
-        if( !((lgrn_t*)lua_touserdata( L, -1 ))->removed ){
+        if( !g->removed )
+        {
+            // reuse a database that opened before fork
+            if( g->pid != getpid() && postfork( L, g ) != GRN_SUCCESS ){
+                lua_pushnil( L );
+                lua_pushstring( L, g->ctx.errbuf );
+                return 2;
+            }
             return 1;
         }
         lua_pop( L, 1 );
@@ -527,17 +1822,26 @@ static int new_lua( lua_State *L )
     if( ( g = lua_newuserdata( L, sizeof( lgrn_t ) ) ) )
     {
         grn_obj *db = NULL;
+        uint64_t t0 = 0;
+        
+        lgrn_init( g, readonly );
         
-        grn_ctx_init( &g->ctx, 0 );
-        g->removed = 0;
+        LGRN_PROBE1( open__entry, path );
+        t0 = lgrn_clock_ns();
+        db = grn_db_open( &g->ctx, path );
+        // create database if path does not exists
+        if( !db && create ){
+            db = grn_db_create( &g->ctx, path, NULL );
+        }
+        t0 = lgrn_clock_ns() - t0;
+        LGRN_PROBE3( open__return, path, t0, db != NULL );
         
-        if(( db = grn_db_open( &g->ctx, path ) ) ||
-            // create database if path does not exists
-            ( lua_isboolean( L, 2 ) && lua_toboolean( L, 2 ) &&
-            ( db = grn_db_create( &g->ctx, path, NULL ) ) ) ){
+        if( db ){
+            lgrn_stats_add( &g->stats.ops[LGRN_OP_OPEN], t0 );
             lstate_setmetatable( L, MODULE_MT );
+            g->ref_objs = lgrn_refnew_obj( L );
             // save reference
-            lgrn_refset_db( L, path, len, -1 );
+            lgrn_refset_db( L, key, klen, -1 );
             return 1;
         }
         
@@ -579,6 +1883,62 @@ static int version_lua( lua_State *L )
 }
 
 
+// MARK: fork hooks
+
+// flush all opened databases before fork
+static int prefork_lua( lua_State *L )
+{
+    lgrn_t *g = NULL;
+    
+    lgrn_refpush_db( L );
+    lua_pushnil( L );
+    while( lua_next( L, -2 ) )
+    {
+        g = (lgrn_t*)lua_touserdata( L, -1 );
+        // flusher thread must not exist at fork
+        if( g && !g->removed && g->flusher ){
+            lgrn_flusher_suspend( g->flusher );
+        }
+        if( g && !g->removed && !g->readonly &&
+            grn_obj_flush( &g->ctx, lgrn_get_db( g ) ) != GRN_SUCCESS ){
+            lua_pushboolean( L, 0 );
+            lua_pushstring( L, g->ctx.errbuf );
+            return 2;
+        }
+        lua_pop( L, 1 );
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+// reinitialize all databases that inherited from the parent process
+static int postfork_lua( lua_State *L )
+{
+    pid_t pid = getpid();
+    lgrn_t *g = NULL;
+    
+    lgrn_refpush_db( L );
+    lua_pushnil( L );
+    while( lua_next( L, -2 ) )
+    {
+        g = (lgrn_t*)lua_touserdata( L, -1 );
+        if( g && !g->removed && 
+            ( g->pid != pid ? postfork( L, g ) : 
+                              resume_flusher( g ) ) != GRN_SUCCESS ){
+            lua_pushboolean( L, 0 );
+            lua_pushstring( L, g->ctx.errbuf );
+            return 2;
+        }
+        lua_pop( L, 1 );
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
 // MARK: globals
 
 // finalizing groonga library
@@ -620,6 +1980,122 @@ static int global_init( lua_State *L )
 }
 
 
+static int gmemory_lua( lua_State *L )
+{
+    const char **prefixes = NULL;
+    size_t nprefixes = 0;
+    lgrn_smaps_t m;
+    
+    // count opened databases
+    lgrn_refpush_db( L );
+    lua_pushnil( L );
+    while( lua_next( L, -2 ) ){
+        nprefixes++;
+        lua_pop( L, 1 );
+    }
+    
+    // collect the paths of databases
+    prefixes = lua_newuserdata( L, sizeof( char* ) * ( nprefixes + 1 ) );
+    if( !prefixes ){
+        lua_pushnil( L );
+        lua_pushstring( L, strerror( errno ) );
+        return 2;
+    }
+    nprefixes = 0;
+    lua_pushnil( L );
+    while( lua_next( L, -3 ) )
+    {
+        lgrn_t *g = lua_touserdata( L, -1 );
+        
+        if( !g->removed && g->pid == getpid() ){
+            prefixes[nprefixes] = grn_obj_path( lgrn_get_ctx( g ), 
+                                                lgrn_get_db( g ) );
+            if( prefixes[nprefixes] ){
+                nprefixes++;
+            }
+        }
+        lua_pop( L, 1 );
+    }
+    prefixes[nprefixes] = NULL;
+    
+    if( lgrn_memory_smaps( &m, prefixes ) == -1 ){
+        lua_pushnil( L );
+        lua_pushstring( L, strerror( errno ) );
+        return 2;
+    }
+    
+    lua_createtable( L, 0, 5 );
+    lstate_int2tbl( L, "lua", (lua_Integer)lua_gc( L, LUA_GCCOUNT, 0 ) * 1024 + 
+                              lua_gc( L, LUA_GCCOUNTB, 0 ) );
+    lstate_int2tbl( L, "rss", (lua_Integer)m.rss );
+    lstate_int2tbl( L, "anon", (lua_Integer)m.anon );
+    lstate_int2tbl( L, "file", (lua_Integer)m.file );
+    lstate_int2tbl( L, "mapped", (lua_Integer)m.matched );
+    
+    return 1;
+}
+
+
+static int capture_log_lua( lua_State *L )
+{
+    int level = GRN_LOG_NONE;
+    unsigned int qflags = 0;
+    
+    // check arguments
+    if( lua_type( L, 1 ) == LUA_TTABLE )
+    {
+        const char *name = NULL;
+        
+        lua_settop( L, 1 );
+        name = lstate_toptstring( L, "level", "notice" );
+        if( ( level = lgrn_logger_level( name ) ) == -1 ){
+            return luaL_argerror( L, 1, "invalid level value" );
+        }
+        if( lstate_toptboolean( L, "query", 0 ) ){
+            qflags = GRN_QUERY_LOG_ALL;
+        }
+    }
+    else if( !lua_isnoneornil( L, 1 ) ){
+        luaL_checktype( L, 1, LUA_TBOOLEAN );
+        // restore default loggers if false
+        if( lua_toboolean( L, 1 ) ){
+            level = GRN_LOG_NOTICE;
+        }
+    }
+    else {
+        level = GRN_LOG_NOTICE;
+    }
+    
+    if( lgrn_logger_capture( level, qflags ) != GRN_SUCCESS ){
+        lua_pushboolean( L, 0 );
+        lua_pushstring( L, "failed to set logger" );
+        return 2;
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+static int drain_log_lua( lua_State *L )
+{
+    lua_Integer max = luaL_optinteger( L, 1, 0 );
+    uint64_t ndropped = 0;
+    
+    if( max < 0 ){
+        return luaL_argerror( L, 1, "max must be greater than or equal to 0" );
+    }
+    else if( lgrn_logger_drain( L, (size_t)max, &ndropped ) == -1 ){
+        lua_pushnil( L );
+        lua_pushstring( L, strerror( errno ) );
+        return 2;
+    }
+    lua_pushnumber( L, (lua_Number)ndropped );
+    
+    return 2;
+}
+
+
 LUALIB_API int luaopen_groonga( lua_State *L )
 {
     struct luaL_Reg mmethods[] = {
@@ -630,22 +2106,41 @@ LUALIB_API int luaopen_groonga( lua_State *L )
     struct luaL_Reg methods[] = {
         { "remove", remove_lua },
         { "touch", touch_lua },
+        { "flush", flush_lua },
+        { "autoFlush", auto_flush_lua },
+        { "prewarm", prewarm_lua },
+        { "defrag", defrag_lua },
+        { "lock", lock_lua },
+        { "unlock", unlock_lua },
+        { "isLocked", is_locked_lua },
+        { "clearLock", clear_lock_lua },
+        { "snapshot", snapshot_lua },
         { "path", path_lua },
         { "tableCreate", table_create_lua },
         { "table", table_lua },
         { "tables", tables_lua },
+        { "execute", execute_lua },
+        { "executeBatch", execute_batch_lua },
+        { "stats", stats_lua },
+        { "resetStats", reset_stats_lua },
+        { "onSlow", on_slow_lua },
+        { "memory", memory_lua },
         { NULL, NULL }
     };
     struct luaL_Reg funcs[] = {
         { "version", version_lua },
         { "encoding", encoding_lua },
         { "new", new_lua },
+        { "prefork", prefork_lua },
+        { "postfork", postfork_lua },
+        { "captureLog", capture_log_lua },
+        { "drainLog", drain_log_lua },
+        { "memory", gmemory_lua },
         { NULL, NULL }
     };
     
     // initialize groonga global variables
     global_init( L );
-    tbl_iter_init_mt( L );
     lgrn_constants_init( L );
     lgrn_weakref_init( L );
     // create metatable
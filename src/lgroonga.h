@@ -35,9 +35,11 @@
 #include <errno.h>
 #include <stdint.h>
 #include <math.h>
+#include <time.h>
 #include <lua.h>
 #include <lauxlib.h>
 #include <groonga/groonga.h>
+#include "probes.h"
 
 // MARK: helper macros
 #define pdealloc(p)     free((void*)(p))
@@ -207,6 +209,7 @@ static inline int lstate_toptboolean( lua_State *L, const char *k, int defval )
 #define GROONGA_MT          "groonga"
 #define GROONGA_TABLE_MT    "groonga.table"
 #define GROONGA_COLUMN_MT   "groonga.column"
+#define GROONGA_POSTINGS_MT "groonga.postings"
 
 
 // MARK: prototypes
@@ -222,6 +225,7 @@ int lgrn_n2i_data( lua_State *L, const char *name );
 int lgrn_n2i_table( lua_State *L, const char *name );
 int lgrn_n2i_column( lua_State *L, const char *name );
 int lgrn_n2i_compress( lua_State *L, const char *name );
+int lgrn_n2i_output( lua_State *L, const char *name );
 // get name by constants value
 const char *lgrn_i2n_data( lua_State *L, int id, size_t *len );
 const char *lgrn_i2n_table( lua_State *L, int id, size_t *len );
@@ -284,6 +288,52 @@ static inline int lgrn_register_mt( lua_State *L, const char *tname,
 }
 
 
+// iteration mode of object iterators
+enum {
+    // name only
+    LGRN_ITER_NAME = 0,
+    // name and grn_id
+    LGRN_ITER_ID,
+    // name and object
+    LGRN_ITER_OBJ,
+    // name and a single object that reused by each iteration
+    LGRN_ITER_LIGHT
+};
+
+// returns -1 if the argument at idx is not a valid mode
+static inline int lgrn_iter_mode( lua_State *L, int idx )
+{
+    const char *mode = NULL;
+    
+    switch( lua_type( L, idx ) ){
+        case LUA_TNONE:
+        case LUA_TNIL:
+            return LGRN_ITER_NAME;
+        // for backward compatibility
+        case LUA_TBOOLEAN:
+            return lua_toboolean( L, idx ) ? LGRN_ITER_OBJ : LGRN_ITER_NAME;
+        case LUA_TSTRING:
+            mode = lua_tostring( L, idx );
+            if( strcmp( mode, "name" ) == 0 ){
+                return LGRN_ITER_NAME;
+            }
+            else if( strcmp( mode, "id" ) == 0 ){
+                return LGRN_ITER_ID;
+            }
+            else if( strcmp( mode, "object" ) == 0 ){
+                return LGRN_ITER_OBJ;
+            }
+            else if( strcmp( mode, "light" ) == 0 ){
+                return LGRN_ITER_LIGHT;
+            }
+            return -1;
+        
+        default:
+            return -1;
+    }
+}
+
+
 // MARK: object
 typedef struct {
     int len;
@@ -320,16 +370,126 @@ static inline int lgrn_obj_istbl( grn_obj *obj )
 }
 
 
+// MARK: operation stats
+enum {
+    LGRN_OP_OPEN = 0,
+    LGRN_OP_TABLE,
+    LGRN_OP_COLUMN,
+    LGRN_OP_DDL,
+    LGRN_OP_EXECUTE,
+    LGRN_OP_FLUSH,
+    LGRN_OP_MAX
+};
+
+// names of operations
+extern const char *const LGRN_OP_NAMES[LGRN_OP_MAX];
+
+// log-linear latency histogram that has 8 sub-buckets for each power of 2
+// nanoseconds. latencies greater than 2^40 nanoseconds go to last bucket.
+#define LGRN_HIST_SUBBITS   3
+#define LGRN_HIST_MAXBITS   40
+#define LGRN_HIST_NBUCKET   \
+    ((LGRN_HIST_MAXBITS - LGRN_HIST_SUBBITS + 2) << LGRN_HIST_SUBBITS)
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint64_t buckets[LGRN_HIST_NBUCKET];
+} lgrn_hist_t;
+
+typedef struct {
+    lgrn_hist_t ops[LGRN_OP_MAX];
+} lgrn_stats_t;
+
+void lgrn_stats_reset( lgrn_stats_t *s );
+void lgrn_stats_add( lgrn_hist_t *h, uint64_t ns );
+// push a table of stats
+void lgrn_stats_push( lua_State *L, lgrn_stats_t *s );
+
+
+static inline uint64_t lgrn_clock_ns( void )
+{
+    struct timespec ts;
+    
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+// MARK: auto flush
+typedef struct lgrn_flusher_st lgrn_flusher_t;
+
+lgrn_flusher_t *lgrn_flusher_start( grn_obj *db, uint32_t nwrites, 
+                                    uint32_t interval );
+void lgrn_flusher_stop( lgrn_flusher_t *f );
+void lgrn_flusher_suspend( lgrn_flusher_t *f );
+int lgrn_flusher_resume( lgrn_flusher_t *f, grn_obj *db );
+lgrn_flusher_t *lgrn_flusher_postfork( lgrn_flusher_t *f, grn_obj *db );
+void lgrn_flusher_wrote( lgrn_flusher_t *f );
+
+
+// MARK: pinned files
+typedef struct lgrn_pins_st lgrn_pins_t;
+
+// unmap the pinned mappings
+void lgrn_files_unpin( lgrn_pins_t *pins );
+
+
 // MARK: database
 
 #define LGRN_ENODB  "database has been removed"
+#define LGRN_EREADONLY  "database has been opened in read-only mode"
 
 typedef struct {
     grn_ctx ctx;
     uint8_t removed;
+    uint8_t readonly;
+    // process that owns the context
+    pid_t pid;
+    lgrn_flusher_t *flusher;
+    // weak reference table of tables and columns that indexed by grn_id
+    int ref_objs;
+    // schema generation that incremented at every schema changes
+    uint32_t gen;
+    // table names of database
+    int ref_catalog;
+    uint32_t catalog_gen;
+    // latency histograms of operations
+    lgrn_stats_t stats;
+    // hook function that called when an operation exceeds slow_ns
+    uint64_t slow_ns;
+    int ref_slow;
+    uint8_t in_slow;
+    // last column id that defragmented by the incremental defragmentation
+    grn_id defrag_id;
+    // mappings that pinned by the lock mode of prewarm
+    lgrn_pins_t *pins;
 } lgrn_t;
 
 
+// initialize lgrn_t
+static inline void lgrn_init( lgrn_t *g, int readonly )
+{
+    grn_ctx_init( &g->ctx, 0 );
+    g->removed = 0;
+    g->readonly = (uint8_t)readonly;
+    g->pid = getpid();
+    g->flusher = NULL;
+    g->ref_objs = LUA_NOREF;
+    g->gen = 0;
+    g->ref_catalog = LUA_NOREF;
+    g->catalog_gen = 0;
+    lgrn_stats_reset( &g->stats );
+    g->slow_ns = 0;
+    g->ref_slow = LUA_NOREF;
+    g->in_slow = 0;
+    g->defrag_id = GRN_ID_NIL;
+    g->pins = NULL;
+}
+
+
 static inline grn_ctx *lgrn_get_ctx( lgrn_t *g )
 {
     return &g->ctx;
@@ -342,6 +502,52 @@ static inline grn_obj *lgrn_get_db( lgrn_t *g )
 }
 
 
+// count a write operation for auto flush
+static inline void lgrn_wrote( lgrn_t *g )
+{
+    if( g->flusher ){
+        lgrn_flusher_wrote( g->flusher );
+    }
+}
+
+
+// invalidate schema caches and count a write operation
+static inline void lgrn_schema_changed( lgrn_t *g )
+{
+    g->gen++;
+    lgrn_wrote( g );
+}
+
+
+// call the slow operation hook
+void lgrn_stats_slow( lua_State *L, lgrn_t *g, int op, uint64_t ns, 
+                      const char *detail, size_t len );
+
+// record a latency of operation
+static inline void lgrn_stats_record( lua_State *L, lgrn_t *g, int op, 
+                                      uint64_t ns, const char *detail, 
+                                      size_t len )
+{
+    lgrn_stats_add( &g->stats.ops[op], ns );
+    if( g->slow_ns && ns >= g->slow_ns && !g->in_slow ){
+        lgrn_stats_slow( L, g, op, ns, detail, len );
+    }
+}
+
+// evaluate an expression that returns int and record its latency as op
+#define lgrn_stats_measure(L,g,op,expr) ({ \
+    uint64_t _t0 = 0; \
+    int _rv = 0; \
+    LGRN_PROBE2( op__entry, op, LGRN_OP_NAMES[op] ); \
+    _t0 = lgrn_clock_ns(); \
+    _rv = (expr); \
+    _t0 = lgrn_clock_ns() - _t0; \
+    LGRN_PROBE4( op__return, op, LGRN_OP_NAMES[op], _t0, _rv ); \
+    lgrn_stats_record( L, g, op, _t0, NULL, 0 ); \
+    _rv; \
+})
+
+
 // MARK: table
 
 #define LGRN_ENOTABLE  "table has been removed"
@@ -349,8 +555,17 @@ static inline grn_obj *lgrn_get_db( lgrn_t *g )
 typedef struct {
     lgrn_t *g;
     grn_obj *tbl;
+    grn_id id;
     uint8_t removed;
+    // reusable object of the light iteration mode
+    uint8_t light;
     int ref_g;
+    // weak reference table of resolved columns that indexed by name
+    int ref_cols;
+    uint32_t cols_gen;
+    // column names of table
+    int ref_catalog;
+    uint32_t catalog_gen;
 } lgrn_tbl_t;
 
 
@@ -361,10 +576,28 @@ static inline void lgrn_tbl_init( lgrn_tbl_t *t, lgrn_t *g, grn_obj *tbl,
     t->ref_g = ref;
     t->g = g;
     t->tbl = tbl;
+    t->id = grn_obj_id( lgrn_get_ctx( g ), tbl );
     t->removed = 0;
+    t->light = 0;
+    t->ref_cols = LUA_NOREF;
+    t->cols_gen = 0;
+    t->ref_catalog = LUA_NOREF;
+    t->catalog_gen = 0;
 }
 
 
+// push a table object of id that is cached by the object reference.
+// database object should be placed at gidx. returns 0 if object is not a 
+// table, or -1 on nomem error.
+int lgrn_table_push( lua_State *L, lgrn_t *g, int gidx, grn_id id );
+// get a type object from the field k of table at the top of stack.
+// the value of field should be a data type name, a table name or a table 
+// object. returns -1 if the value is not a type.
+int lgrn_type_opt( lua_State *L, lgrn_t *g, const char *k, grn_obj **type );
+// push a data type name or a table name of type id
+void lgrn_type_push( lua_State *L, lgrn_t *g, grn_id id );
+
+
 // MARK: column management
 
 #define LGRN_ENOCOLUMN  "column has been removed"
@@ -372,7 +605,10 @@ static inline void lgrn_tbl_init( lgrn_tbl_t *t, lgrn_t *g, grn_obj *tbl,
 typedef struct {
     lgrn_tbl_t *t;
     grn_obj *col;
+    grn_id id;
     uint8_t removed;
+    // reusable object of the light iteration mode
+    uint8_t light;
     int ref_t;
 } lgrn_col_t;
 
@@ -384,7 +620,9 @@ static inline void lgrn_col_init( lgrn_col_t *c, lgrn_tbl_t *t, grn_obj *col,
     c->ref_t = ref;
     c->t = t;
     c->col = col;
+    c->id = grn_obj_id( lgrn_get_ctx( t->g ), col );
     c->removed = 0;
+    c->light = 0;
 }
 
 
@@ -394,13 +632,80 @@ void lgrn_weakref_init( lua_State *L );
 // db reference
 int lgrn_refget_db( lua_State *L, const char *name, size_t len );
 void lgrn_refset_db( lua_State *L, const char *name, size_t len, int idx );
-// table reference
-int lgrn_refget_tbl( lua_State *L, const char *name, size_t len );
-void lgrn_refset_tbl( lua_State *L, const char *name, size_t len, int idx );
-// column reference
-int lgrn_refget_col( lua_State *L, const char *name, size_t len );
-void lgrn_refset_col( lua_State *L, const char *name, size_t len, int idx );
+// push a weak reference table of db
+void lgrn_refpush_db( lua_State *L );
+// table and column reference of database
+int lgrn_refnew_obj( lua_State *L );
+int lgrn_refget_obj( lua_State *L, lgrn_t *g, grn_id id, const char *tname );
+void lgrn_refset_obj( lua_State *L, lgrn_t *g, grn_id id, int idx );
+void lgrn_refdel_obj( lua_State *L, lgrn_t *g, grn_id id );
+// mark the tables and columns that removed by commands as removed, or 
+// mark the temporary tables and columns as removed if tmp is not 0
+void lgrn_refsweep_obj( lua_State *L, lgrn_t *g, int tmp );
+
+
+// MARK: object files
+enum {
+    LGRN_PREWARM_WILLNEED = 0,
+    LGRN_PREWARM_TOUCH,
+    LGRN_PREWARM_LOCK
+};
+// collect files of the object path into the table at the top of stack
+int lgrn_files_collect( lua_State *L, const char *path );
+// collect files of the object paths that listed in the keys of table at idx
+// into the table at the top of stack
+int lgrn_files_collectv( lua_State *L, int idx );
+// prewarm files that listed in the keys of table at idx. the pinned 
+// mappings of LGRN_PREWARM_LOCK mode are returned to pins.
+int lgrn_files_prewarm( lua_State *L, int idx, int mode, int nthreads,
+                        size_t *nfiles, size_t *nbytes, lgrn_pins_t **pins );
+// total allocated size of files that listed in the keys of table at idx
+int lgrn_files_usage( lua_State *L, int idx, size_t *nbytes );
+// copy files that listed in the keys of table at idx into the dest directory
+typedef struct {
+    size_t nfiles;
+    size_t nbytes;
+    // number of files that copied by reflink
+    size_t ncloned;
+} lgrn_copystat_t;
+
+int lgrn_files_copy( lua_State *L, int idx, const char *dest, 
+                     lgrn_copystat_t *stat );
+
 
+// MARK: logger
+// returns -1 if name is not a log level
+int lgrn_logger_level( const char *name );
+// capture logs into the ring buffer
+grn_rc lgrn_logger_capture( int level, unsigned int qflags );
+// push an array of captured logs
+int lgrn_logger_drain( lua_State *L, size_t max, uint64_t *ndropped );
+
+
+// MARK: memory usage
+typedef struct {
+    // resident size of all mappings
+    size_t rss;
+    // resident size of anonymous mappings
+    size_t anon;
+    // resident size of file mappings
+    size_t file;
+    // resident size of file mappings that matched to prefixes
+    size_t matched;
+} lgrn_smaps_t;
+
+// prefixes must be terminated by NULL
+int lgrn_memory_smaps( lgrn_smaps_t *m, const char **prefixes );
+
+
+// MARK: command execution
+// returns 1 if the command does not modify the database
+int lgrn_cmd_isreadonly( const char *cmd, size_t len );
+// returns 1 if the command changes the schema
+int lgrn_cmd_isschema( const char *cmd, size_t len );
+// push the output of command, or pass it to the function at fnidx
+int lgrn_cmd_exec( lua_State *L, lgrn_t *g, const char *cmd, size_t len, 
+                   grn_content_type otype, int fnidx );
 
 
 #endif
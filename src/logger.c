@@ -0,0 +1,254 @@
+/*
+ *  Copyright 2015 Masatoshi Teruya. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a 
+ *  copy of this software and associated documentation files (the "Software"), 
+ *  to deal in the Software without restriction, including without limitation 
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ *  and/or sell copies of the Software, and to permit persons to whom the 
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL 
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ *  logger.c
+ *  lua-groonga
+ *
+ */
+
+
+#include "lgroonga.h"
+#include <pthread.h>
+
+// MARK: ring buffer
+
+// number of slots must be power of 2
+#define LOG_NSLOT   1024
+#define LOG_MSGLEN  480
+
+enum {
+    LOG_TYPE_LOG = 0,
+    LOG_TYPE_QUERY
+};
+
+typedef struct {
+    // 2 * ticket + 1 while writing, 2 * ticket + 2 after written
+    uint64_t seq;
+    uint8_t type;
+    uint32_t level;
+    char time[32];
+    char msg[LOG_MSGLEN];
+} logent_t;
+
+static logent_t RING[LOG_NSLOT];
+// next ticket of writers
+static uint64_t HEAD = 0;
+// next ticket of reader
+static uint64_t TAIL = 0;
+static uint64_t NDROPPED = 0;
+static pthread_mutex_t DRAIN_MUTEX = PTHREAD_MUTEX_INITIALIZER;
+
+
+// writers never block each other. an entry that overwritten before reading
+// is counted as a dropped entry by reader.
+static void ring_put( uint8_t type, uint32_t level, const char *timestamp, 
+                      const char *head, const char *msg )
+{
+    uint64_t ticket = __atomic_fetch_add( &HEAD, 1, __ATOMIC_RELAXED );
+    logent_t *e = &RING[ticket & ( LOG_NSLOT - 1 )];
+    
+    __atomic_store_n( &e->seq, ticket * 2 + 1, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    
+    e->type = type;
+    e->level = level;
+    snprintf( e->time, sizeof( e->time ), "%s", timestamp ? timestamp : "" );
+    snprintf( e->msg, LOG_MSGLEN, "%s%s", head ? head : "", msg ? msg : "" );
+    
+    __atomic_store_n( &e->seq, ticket * 2 + 2, __ATOMIC_RELEASE );
+}
+
+
+// copy up to max entries into buf
+static size_t ring_get( logent_t *buf, size_t max, uint64_t *ndropped )
+{
+    uint64_t head = __atomic_load_n( &HEAD, __ATOMIC_ACQUIRE );
+    size_t n = 0;
+    
+    pthread_mutex_lock( &DRAIN_MUTEX );
+    // skip overwritten entries
+    if( head - TAIL > LOG_NSLOT ){
+        NDROPPED += head - TAIL - LOG_NSLOT;
+        TAIL = head - LOG_NSLOT;
+    }
+    
+    while( TAIL < head && n < max )
+    {
+        logent_t *e = &RING[TAIL & ( LOG_NSLOT - 1 )];
+        uint64_t seq = __atomic_load_n( &e->seq, __ATOMIC_ACQUIRE );
+        
+        // writer is still writing
+        if( seq < TAIL * 2 + 2 ){
+            break;
+        }
+        else if( seq == TAIL * 2 + 2 )
+        {
+            memcpy( &buf[n], e, sizeof( logent_t ) );
+            __atomic_thread_fence( __ATOMIC_ACQUIRE );
+            // entry has not been overwritten while copying
+            if( __atomic_load_n( &e->seq, __ATOMIC_RELAXED ) == seq ){
+                n++;
+                TAIL++;
+                continue;
+            }
+        }
+        NDROPPED++;
+        TAIL++;
+    }
+    
+    *ndropped = NDROPPED;
+    NDROPPED = 0;
+    pthread_mutex_unlock( &DRAIN_MUTEX );
+    
+    return n;
+}
+
+
+// MARK: loggers
+
+static const char *LEVEL_NAMES[] = {
+    "none",
+    "emergency",
+    "alert",
+    "critical",
+    "error",
+    "warning",
+    "notice",
+    "info",
+    "debug",
+    "dump",
+    NULL
+};
+
+
+int lgrn_logger_level( const char *name )
+{
+    int i = 0;
+    
+    for(; LEVEL_NAMES[i]; i++ ){
+        if( strcmp( LEVEL_NAMES[i], name ) == 0 ){
+            return i;
+        }
+    }
+    
+    return -1;
+}
+
+
+static void log_cb( grn_ctx *ctx, grn_log_level level, const char *timestamp,
+                    const char *title, const char *message, 
+                    const char *location, void *user_data )
+{
+    ring_put( LOG_TYPE_LOG, (uint32_t)level, timestamp, NULL, message );
+}
+
+
+static void query_log_cb( grn_ctx *ctx, unsigned int flag, 
+                          const char *timestamp, const char *info, 
+                          const char *message, void *user_data )
+{
+    ring_put( LOG_TYPE_QUERY, flag, timestamp, info, message );
+}
+
+
+static grn_logger LOGGER = {
+    .max_level = GRN_LOG_NOTICE,
+    .flags = GRN_LOG_TIME | GRN_LOG_MESSAGE,
+    .user_data = NULL,
+    .log = log_cb,
+    .reopen = NULL,
+    .fin = NULL
+};
+
+static grn_query_logger QUERY_LOGGER = {
+    .flags = GRN_QUERY_LOG_ALL,
+    .user_data = NULL,
+    .log = query_log_cb,
+    .reopen = NULL,
+    .fin = NULL
+};
+
+
+// loggers are shared by all contexts of process. default logger is restored
+// if level is GRN_LOG_NONE, and default query logger is restored if qflags
+// is 0.
+grn_rc lgrn_logger_capture( int level, unsigned int qflags )
+{
+    grn_ctx ctx;
+    grn_rc rc = GRN_SUCCESS;
+    
+    grn_ctx_init( &ctx, 0 );
+    LOGGER.max_level = (grn_log_level)level;
+    rc = grn_logger_set( &ctx, level == GRN_LOG_NONE ? NULL : &LOGGER );
+    if( rc == GRN_SUCCESS ){
+        QUERY_LOGGER.flags = qflags;
+        rc = grn_query_logger_set( &ctx, qflags ? &QUERY_LOGGER : NULL );
+    }
+    grn_ctx_fin( &ctx );
+    
+    return rc;
+}
+
+
+// MARK: drain
+
+// push an array of captured log entries
+int lgrn_logger_drain( lua_State *L, size_t max, uint64_t *ndropped )
+{
+    logent_t *buf = NULL;
+    size_t n = 0;
+    size_t i = 0;
+    
+    if( !max || max > LOG_NSLOT ){
+        max = LOG_NSLOT;
+    }
+    // buffer is released by gc even if lua api raises an error
+    if( !( buf = lua_newuserdata( L, sizeof( logent_t ) * max ) ) ){
+        return -1;
+    }
+    
+    // do not call lua api while holding lock
+    n = ring_get( buf, max, ndropped );
+    
+    lua_createtable( L, (int)n, 0 );
+    for(; i < n; i++ )
+    {
+        logent_t *e = &buf[i];
+        
+        lua_createtable( L, 0, 4 );
+        if( e->type == LOG_TYPE_LOG ){
+            lstate_str2tbl( L, "type", "log" );
+            lstate_str2tbl( L, "level", e->level < GRN_LOG_DUMP + 1 ? 
+                                        LEVEL_NAMES[e->level] : "unknown" );
+        }
+        else {
+            lstate_str2tbl( L, "type", "query" );
+            lstate_int2tbl( L, "flag", e->level );
+        }
+        lstate_str2tbl( L, "time", e->time );
+        lstate_str2tbl( L, "message", e->msg );
+        lua_rawseti( L, -2, (int)i + 1 );
+    }
+    lua_remove( L, -2 );
+    
+    return 0;
+}
+
@@ -0,0 +1,109 @@
+/*
+ *  Copyright 2015 Masatoshi Teruya. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a 
+ *  copy of this software and associated documentation files (the "Software"), 
+ *  to deal in the Software without restriction, including without limitation 
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ *  and/or sell copies of the Software, and to permit persons to whom the 
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL 
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ *  memory.c
+ *  lua-groonga
+ *
+ */
+
+
+#include "lgroonga.h"
+#include <stdio.h>
+
+
+// returns 1 if path is a file of prefix or "<prefix>.<suffix>"
+static int has_prefix( const char *path, const char **prefixes )
+{
+    for(; *prefixes; prefixes++ )
+    {
+        size_t len = strlen( *prefixes );
+        
+        if( strncmp( path, *prefixes, len ) == 0 && 
+            ( path[len] == 0 || path[len] == '.' ) ){
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+
+// sum up the resident sizes of mappings in /proc/self/smaps. the sizes of
+// mappings that belong to the files of prefixes are added to m->matched.
+int lgrn_memory_smaps( lgrn_smaps_t *m, const char **prefixes )
+{
+    FILE *fp = fopen( "/proc/self/smaps", "r" );
+    char line[4096];
+    // category of current mapping; 0: anonymous, 1: file, 2: matched file
+    int cat = 0;
+    
+    memset( m, 0, sizeof( lgrn_smaps_t ) );
+    if( !fp ){
+        return -1;
+    }
+    
+    while( fgets( line, sizeof( line ), fp ) )
+    {
+        unsigned long kb = 0;
+        unsigned long from = 0;
+        unsigned long to = 0;
+        char *path = NULL;
+        
+        // size field
+        if( sscanf( line, "Rss: %lu kB", &kb ) == 1 )
+        {
+            size_t bytes = (size_t)kb * 1024;
+            
+            m->rss += bytes;
+            if( cat == 0 ){
+                m->anon += bytes;
+            }
+            else
+            {
+                m->file += bytes;
+                if( cat == 2 ){
+                    m->matched += bytes;
+                }
+            }
+        }
+        // header line of mapping starts with an address range
+        else if( sscanf( line, "%lx-%lx ", &from, &to ) == 2 )
+        {
+            // trim trailing newline
+            line[strcspn( line, "\n" )] = 0;
+            // pathname starts with a slash
+            if( !( path = strchr( line, '/' ) ) ){
+                cat = 0;
+            }
+            else if( prefixes && has_prefix( path, prefixes ) ){
+                cat = 2;
+            }
+            else {
+                cat = 1;
+            }
+        }
+    }
+    
+    fclose( fp );
+    
+    return 0;
+}
+
@@ -0,0 +1,64 @@
+/*
+ *  Copyright 2015 Masatoshi Teruya. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a 
+ *  copy of this software and associated documentation files (the "Software"), 
+ *  to deal in the Software without restriction, including without limitation 
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ *  and/or sell copies of the Software, and to permit persons to whom the 
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL 
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ *  probes.h
+ *  lua-groonga
+ *
+ */
+
+
+#ifndef lgroonga_probes_h
+#define lgroonga_probes_h
+
+// statically defined tracing probes of the "lgroonga" provider.
+// probes are compiled out if <sys/sdt.h> is not available or
+// LGRN_NO_PROBES is defined, and the arguments are not evaluated.
+//
+//  e.g. bpftrace -e 'usdt:./groonga.so:lgroonga:op__return { ... }'
+#if !defined(LGRN_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define LGRN_HAVE_PROBES    1
+#endif
+#endif
+
+#ifdef LGRN_HAVE_PROBES
+
+#define LGRN_PROBE1(name,a1) \
+    DTRACE_PROBE1( lgroonga, name, a1 )
+#define LGRN_PROBE2(name,a1,a2) \
+    DTRACE_PROBE2( lgroonga, name, a1, a2 )
+#define LGRN_PROBE3(name,a1,a2,a3) \
+    DTRACE_PROBE3( lgroonga, name, a1, a2, a3 )
+#define LGRN_PROBE4(name,a1,a2,a3,a4) \
+    DTRACE_PROBE4( lgroonga, name, a1, a2, a3, a4 )
+
+#else
+
+#define LGRN_PROBE1(name,a1)                do{}while(0)
+#define LGRN_PROBE2(name,a1,a2)             do{}while(0)
+#define LGRN_PROBE3(name,a1,a2,a3)          do{}while(0)
+#define LGRN_PROBE4(name,a1,a2,a3,a4)       do{}while(0)
+
+#endif
+
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ *  Copyright 2015 Masatoshi Teruya. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a 
+ *  copy of this software and associated documentation files (the "Software"), 
+ *  to deal in the Software without restriction, including without limitation 
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+ *  and/or sell copies of the Software, and to permit persons to whom the 
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL 
+ *  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ *  stats.c
+ *  lua-groonga
+ *
+ */
+
+
+#include "lgroonga.h"
+
+
+const char *const LGRN_OP_NAMES[LGRN_OP_MAX] = {
+    "open",
+    "table",
+    "column",
+    "ddl",
+    "execute",
+    "flush"
+};
+
+
+void lgrn_stats_reset( lgrn_stats_t *s )
+{
+    int i = 0;
+    
+    memset( s, 0, sizeof( lgrn_stats_t ) );
+    for(; i < LGRN_OP_MAX; i++ ){
+        s->ops[i].min = UINT64_MAX;
+    }
+}
+
+
+// MARK: histogram
+
+static inline int bucket_index( uint64_t ns )
+{
+    int e = 0;
+    
+    // values less than 2^SUBBITS are stored as-is
+    if( ns < ( 1 << LGRN_HIST_SUBBITS ) ){
+        return (int)ns;
+    }
+    
+    e = 63 - __builtin_clzll( ns );
+    if( e > LGRN_HIST_MAXBITS ){
+        return LGRN_HIST_NBUCKET - 1;
+    }
+    
+    return ( ( e - LGRN_HIST_SUBBITS + 1 ) << LGRN_HIST_SUBBITS ) + 
+           (int)( ( ns >> ( e - LGRN_HIST_SUBBITS ) ) & 
+                  ( ( 1 << LGRN_HIST_SUBBITS ) - 1 ) );
+}
+
+
+// returns a highest value of bucket
+static inline uint64_t bucket_value( int idx )
+{
+    int e = ( idx >> LGRN_HIST_SUBBITS ) + LGRN_HIST_SUBBITS - 1;
+    uint64_t sub = (uint64_t)( idx & ( ( 1 << LGRN_HIST_SUBBITS ) - 1 ) );
+    
+    if( idx < ( 1 << LGRN_HIST_SUBBITS ) ){
+        return (uint64_t)idx;
+    }
+    
+    return ( ( ( 1ULL << LGRN_HIST_SUBBITS ) + sub + 1 ) << 
+             ( e - LGRN_HIST_SUBBITS ) ) - 1;
+}
+
+
+void lgrn_stats_add( lgrn_hist_t *h, uint64_t ns )
+{
+    h->count++;
+    h->sum += ns;
+    if( ns < h->min ){
+        h->min = ns;
+    }
+    if( ns > h->max ){
+        h->max = ns;
+    }
+    h->buckets[bucket_index( ns )]++;
+}
+
+
+// returns a value at percentile p
+static uint64_t percentile( lgrn_hist_t *h, double p )
+{
+    uint64_t rank = (uint64_t)ceil( (double)h->count * p / 100.0 );
+    uint64_t total = 0;
+    int i = 0;
+    
+    if( rank < 1 ){
+        rank = 1;
+    }
+    for(; i < LGRN_HIST_NBUCKET; i++ )
+    {
+        total += h->buckets[i];
+        if( total >= rank ){
+            uint64_t val = bucket_value( i );
+            return val > h->max ? h->max : val;
+        }
+    }
+    
+    return h->max;
+}
+
+
+// MARK: slow operation hook
+
+void lgrn_stats_slow( lua_State *L, lgrn_t *g, int op, uint64_t ns, 
+                      const char *detail, size_t len )
+{
+    // hook function should not be called recursively
+    g->in_slow = 1;
+    lstate_pushref( L, g->ref_slow );
+    lua_pushstring( L, LGRN_OP_NAMES[op] );
+    lua_pushnumber( L, (lua_Number)ns / 1000000.0 );
+    if( detail ){
+        lua_pushlstring( L, detail, len );
+    }
+    else {
+        lua_pushnil( L );
+    }
+    // ignore errors of hook function
+    if( lua_pcall( L, 3, 0, 0 ) ){
+        lua_pop( L, 1 );
+    }
+    g->in_slow = 0;
+}
+
+
+// MARK: lua table
+
+#define usec2tbl(L,k,ns) do{ \
+    lua_pushstring( L, k ); \
+    lua_pushnumber( L, (lua_Number)(ns) / 1000.0 ); \
+    lua_rawset( L, -3 ); \
+}while(0)
+
+void lgrn_stats_push( lua_State *L, lgrn_stats_t *s )
+{
+    int i = 0;
+    
+    lua_createtable( L, 0, LGRN_OP_MAX );
+    for(; i < LGRN_OP_MAX; i++ )
+    {
+        lgrn_hist_t *h = &s->ops[i];
+        
+        lua_pushstring( L, LGRN_OP_NAMES[i] );
+        lua_createtable( L, 0, 8 );
+        lstate_int2tbl( L, "count", (lua_Integer)h->count );
+        if( h->count )
+        {
+            usec2tbl( L, "min", h->min );
+            usec2tbl( L, "max", h->max );
+            usec2tbl( L, "mean", (double)h->sum / (double)h->count );
+            usec2tbl( L, "p50", percentile( h, 50 ) );
+            usec2tbl( L, "p90", percentile( h, 90 ) );
+            usec2tbl( L, "p99", percentile( h, 99 ) );
+            usec2tbl( L, "p999", percentile( h, 99.9 ) );
+        }
+        lua_rawset( L, -3 );
+    }
+}
+
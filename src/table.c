@@ -53,270 +53,511 @@
 #define CHECK_EXISTS( L, t ) \
     CHECK_EXISTS_EX( L, t, CHECK_RET_NIL )
 
+#define CHECK_WRITABLE_EX( L, t, CHECK_RET ) do{ \
+    if( (t)->g->readonly ){ \
+        CHECK_RET; \
+        lua_pushstring( L, LGRN_EREADONLY ); \
+        return 2; \
+    } \
+}while(0)
 
+#define CHECK_WRITABLE( L, t ) \
+    CHECK_WRITABLE_EX( L, t, CHECK_RET_NIL )
+
+#define CHECK_UNLIGHT_EX( L, t, CHECK_RET ) do{ \
+    switch( unlight_table( L, &(t) ) ){ \
+        case 1: \
+        break; \
+        case 0: \
+            CHECK_RET; \
+            lua_pushstring( L, LGRN_ENOTABLE ); \
+            return 2; \
+        default: \
+            CHECK_RET; \
+            lua_pushstring( L, strerror( errno ) ); \
+            return 2; \
+    } \
+}while(0)
 
-// MARK: column lookup iterator
+#define CHECK_UNLIGHT( L, t ) \
+    CHECK_UNLIGHT_EX( L, t, CHECK_RET_NIL )
+
+
+// replace a reusable table object of the light iteration mode at index 1 
+// with the table object that is cached by the object reference. the light 
+// object is retargeted by the next iteration, so it must not be an owner of 
+// the column objects. returns 0 if table has been removed, or -1 on nomem 
+// error.
+static int unlight_table( lua_State *L, lgrn_tbl_t **t )
+{
+    int rc = 1;
+    
+    if( (*t)->light )
+    {
+        lstate_pushref( L, (*t)->ref_g );
+        rc = lgrn_table_push( L, (*t)->g, lua_gettop( L ), (*t)->id );
+        if( rc == 1 ){
+            lua_replace( L, 1 );
+            *t = lua_touserdata( L, 1 );
+        }
+        lua_pop( L, 1 );
+    }
+    
+    return rc;
+}
 
-#define ITERATOR_MT "groonga.column.iterator"
 
-typedef struct {
-    grn_ctx *ctx;
-    grn_hash_cursor *cur;
-    grn_hash *cols;
-    int ncols;
-} col_iter_t;
 
+// MARK: column catalog
 
-// init iterator
-static grn_rc col_iter_init( col_iter_t *it, grn_ctx *ctx, grn_obj *tbl )
+// push a catalog of columns that contains the following fields;
+//  [0]:      number of columns
+//  [1..n]:   column names
+//  [name]:   column id
+static grn_rc catalog_push( lua_State *L, lgrn_tbl_t *t )
 {
-    // create container
-    grn_hash *cols = grn_hash_create( ctx, NULL, sizeof( grn_id ), 0, 
-                                      GRN_OBJ_TABLE_HASH_KEY );
+    grn_ctx *ctx = lgrn_get_ctx( t->g );
+    grn_obj *db = lgrn_get_db( t->g );
+    grn_hash *cols = NULL;
+    grn_hash_cursor *cur = NULL;
+    grn_obj *col = NULL;
+    grn_id *id = NULL;
+    lgrn_objname_t oname;
+    const char *name = NULL;
+    int n = 0;
     
-    if( cols )
+    // schema has not been changed since created
+    if( t->ref_catalog != LUA_NOREF && t->catalog_gen == t->g->gen ){
+        lstate_pushref( L, t->ref_catalog );
+        return GRN_SUCCESS;
+    }
+    else if( !( cols = grn_hash_create( ctx, NULL, sizeof( grn_id ), 0, 
+                                        GRN_OBJ_TABLE_HASH_KEY ) ) ){
+        return ctx->rc;
+    }
+    
+    // cursor range is fixed at open time; fill columns before opening it
+    grn_table_columns( ctx, t->tbl, NULL, 0, (grn_obj*)cols );
+    if( !( cur = grn_hash_cursor_open( ctx, cols, NULL, 0, NULL, 0, 0, -1, 
+                                       0 ) ) ){
+        grn_hash_close( ctx, cols );
+        return ctx->rc;
+    }
+    
+    lua_newtable( L );
+    while( grn_hash_cursor_next( ctx, cur ) != GRN_ID_NIL )
     {
-        it->ncols = grn_table_columns( ctx, tbl, NULL, 0, (grn_obj*)cols );
-        it->cur = grn_hash_cursor_open( ctx, cols, NULL, 0, NULL, 0, 0, -1, 0 );
-        if( it->cur ){
-            it->ctx = ctx;
-            it->cols = cols;
-            return GRN_SUCCESS;
+        if( grn_hash_cursor_get_key_value( ctx, cur, (void**)&id, NULL, 
+                                           NULL ) == GRN_INVALID_ARGUMENT ){
+            continue;
+        }
+        // get a name "<table>.<column>" without opening column
+        else if( ( oname.len = grn_table_get_key( ctx, db, *id, oname.name, 
+                                                  GRN_TABLE_MAX_KEY_SIZE ) ) ){
+            if( !( name = memchr( oname.name, '.', (size_t)oname.len ) ) ){
+                continue;
+            }
+            name++;
+            oname.len -= (int)( name - oname.name );
+        }
+        // column of temporary table
+        else if( ( col = grn_ctx_at( ctx, *id ) ) ){
+            oname.len = grn_column_name( ctx, col, oname.name, 
+                                         GRN_TABLE_MAX_KEY_SIZE );
+            name = oname.name;
+        }
+        else {
+            continue;
         }
         
-        grn_hash_close( ctx, cols );
+        n++;
+        lua_pushlstring( L, name, (size_t)oname.len );
+        lua_pushvalue( L, -1 );
+        lua_rawseti( L, -3, n );
+        lua_pushinteger( L, *id );
+        lua_rawset( L, -3 );
     }
+    grn_hash_cursor_close( ctx, cur );
+    grn_hash_close( ctx, cols );
+    lstate_int2arr( L, 0, n );
     
-    return ctx->rc;
+    // save catalog
+    lstate_unref( L, t->ref_catalog );
+    t->ref_catalog = lstate_refat( L, -1 );
+    t->catalog_gen = t->g->gen;
+    
+    return GRN_SUCCESS;
 }
 
 
-static inline grn_rc col_iter_dispose( col_iter_t *it )
+// MARK: column API
+
+// lookup a column from resolved columns by name at index 2
+static int resolved_get( lua_State *L, lgrn_tbl_t *t )
 {
-    if( it->cur ){
-        grn_hash_cursor_close( it->ctx, it->cur );
-        it->cur = NULL;
-        return grn_hash_close( it->ctx, it->cols );
+    // schema has not been changed since resolved
+    if( t->ref_cols != LUA_NOREF && t->cols_gen == t->g->gen )
+    {
+        lstate_pushref( L, t->ref_cols );
+        lua_pushvalue( L, 2 );
+        lua_rawget( L, -2 );
+        if( lua_type( L, -1 ) == LUA_TUSERDATA ){
+            lua_replace( L, -2 );
+            return 1;
+        }
+        lua_pop( L, 2 );
     }
     
-    return GRN_SUCCESS;
+    return 0;
 }
 
 
-static int col_iter_gc( lua_State *L )
+// save a column at the top of stack to resolved columns by name at index 2
+static void resolved_set( lua_State *L, lgrn_tbl_t *t )
 {
-    col_iter_t *it = lua_touserdata( L, 1 );
-
-    col_iter_dispose( it );
+    // discard resolved columns if schema has been changed
+    if( t->ref_cols == LUA_NOREF || t->cols_gen != t->g->gen ){
+        lstate_unref( L, t->ref_cols );
+        t->ref_cols = lgrn_refnew_obj( L );
+        t->cols_gen = t->g->gen;
+    }
     
-    return 0;
+    lstate_pushref( L, t->ref_cols );
+    lua_pushvalue( L, 2 );
+    lua_pushvalue( L, -3 );
+    lua_rawset( L, -3 );
+    lua_pop( L, 1 );
 }
 
 
-static void col_iter_init_mt( lua_State *L )
+// lookup a column from object reference.
+// id may be reused after the owner table has been removed.
+static int refget_col( lua_State *L, lgrn_t *g, grn_id id )
 {
-    struct luaL_Reg mmethods[] = {
-        { "__gc", col_iter_gc },
-        { NULL, NULL }
-    };
+    if( lgrn_refget_obj( L, g, id, GROONGA_COLUMN_MT ) )
+    {
+        if( !((lgrn_col_t*)lua_touserdata( L, -1 ))->t->removed ){
+            return 1;
+        }
+        lua_pop( L, 1 );
+    }
     
-    lgrn_register_mt( L, ITERATOR_MT, mmethods, NULL );
+    return 0;
 }
 
 
-// lookup a next column of table
-static inline grn_rc col_iter_next( col_iter_t *it, grn_obj **col )
+// lookup an id of column. column of persistent table is not opened.
+static grn_id column_id( grn_ctx *ctx, lgrn_tbl_t *t, const char *name, 
+                         size_t len, grn_obj **col )
 {
-    grn_ctx *ctx = it->ctx;
-    grn_hash_cursor *cur = it->cur;
-    grn_obj *obj = NULL;
-    grn_id *id = NULL;
-    int rv = 0 ;
+    lgrn_objname_t oname;
     
-    while( grn_hash_cursor_next( ctx, cur ) != GRN_ID_NIL )
+    *col = NULL;
+    // temporary table. col is set without id if it is an accessor
+    if( !lgrn_get_objname( &oname, ctx, t->tbl ) )
     {
-        //
-        // ctx: grn_ctx*                    | context
-        // cur: grn_hash_cursor*            | cursor
-        // key: void** or NULL              | key
-        // ksz: unsigned int* or NULL       | key size
-        // val: void** or NULL              | value
-        // ret: int or GRN_INVALID_ARGUMENT | value size
-        //
-        // int grn_hash_cursor_get_key_value( grn_ctx *ctx,
-        //                                    grn_hash_cursor *cur,
-        //                                    void **key, unsigned int *ksz,
-        //                                    void **val );
-        //
-        rv = grn_hash_cursor_get_key_value( ctx, cur, (void**)&id, NULL, NULL );
-        if( rv == GRN_INVALID_ARGUMENT ){
-            return GRN_INVALID_ARGUMENT;
+        if( ( *col = grn_obj_column( ctx, t->tbl, name, (unsigned int)len ) ) ){
+            return grn_obj_id( ctx, *col );
         }
-        else if( ( obj = grn_ctx_at(ctx, *id ) ) ){
-            *col = obj;
-            return GRN_SUCCESS;
-        }
-        else if( ctx->rc != GRN_SUCCESS ){
-            return ctx->rc;
+        return GRN_ID_NIL;
+    }
+    // too long
+    else if( (size_t)oname.len + 1 + len > GRN_TABLE_MAX_KEY_SIZE ){
+        return GRN_ID_NIL;
+    }
+    
+    // lookup by fully qualified name "<table>.<column>"
+    oname.name[oname.len++] = '.';
+    memcpy( oname.name + oname.len, name, len );
+    
+    return grn_table_get( ctx, lgrn_get_db( t->g ), oname.name, 
+                          (unsigned int)( (size_t)oname.len + len ) );
+}
+
+
+// push a column object of id. table object should be placed at tidx.
+// col is used if it is not NULL. returns 0 if column does not exist.
+static int push_column( lua_State *L, lgrn_tbl_t *t, int tidx, grn_id id, 
+                        grn_obj *col )
+{
+    grn_ctx *ctx = lgrn_get_ctx( t->g );
+    lgrn_col_t *c = NULL;
+    
+    // lookup from object reference
+    if( refget_col( L, t->g, id ) ){
+        if( col ){
+            grn_obj_unlink( ctx, col );
         }
-        grn_obj_unlink( ctx, obj );
+        return 1;
+    }
+    else if( !col && !( col = grn_ctx_at( ctx, id ) ) ){
+        return 0;
     }
+    // alloc lgrn_col_t
+    else if( ( c = lua_newuserdata( L, sizeof( lgrn_col_t ) ) ) ){
+        lstate_setmetatable( L, GROONGA_COLUMN_MT );
+        // save reference
+        lgrn_refset_obj( L, t->g, id, -1 );
+        // retain references
+        lgrn_col_init( c, t, col, lstate_refat( L, tidx ) );
+        return 1;
+    }
+    
+    // nomem error
+    grn_obj_unlink( ctx, col );
     
-    return GRN_END_OF_DATA;
+    return -1;
 }
 
 
-// MARK: column API
+// push an accessor object that is not cached by the object reference.
+// table object should be placed at index 1.
+static int push_accessor( lua_State *L, lgrn_tbl_t *t, grn_obj *col )
+{
+    lgrn_col_t *c = lua_newuserdata( L, sizeof( lgrn_col_t ) );
+    
+    if( !c ){
+        grn_obj_unlink( lgrn_get_ctx( t->g ), col );
+        return 0;
+    }
+    lstate_setmetatable( L, GROONGA_COLUMN_MT );
+    lgrn_col_init( c, t, col, lstate_refat( L, 1 ) );
+    
+    return 1;
+}
 
-static int column_lua( lua_State *L )
+
+static int get_column( lua_State *L )
 {
     lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
     size_t len = 0;
     const char *name = NULL;
     grn_ctx *ctx = NULL;
-    lgrn_col_t *c = NULL;
     grn_obj *col = NULL;
+    grn_id id = GRN_ID_NIL;
     
     CHECK_EXISTS( L, t );
     name = luaL_checklstring( L, 2, &len );
+    CHECK_UNLIGHT( L, t );
     ctx = lgrn_get_ctx( t->g );
     
-    if( len > GRN_TABLE_MAX_KEY_SIZE ||
-        !( col = grn_obj_column( ctx, t->tbl, name, (unsigned int)len ) ) ){
-        lua_pushnil( L );
+    // lookup from resolved columns
+    LGRN_PROBE2( resolve__entry, "column", name );
+    if( resolved_get( L, t ) ){
+        LGRN_PROBE3( resolve__return, "column", name, 
+                     ((lgrn_col_t*)lua_touserdata( L, -1 ))->id );
         return 1;
     }
-    // lookup from weak reference
-    else if( lgrn_refget_col( L, name, len ) ){
-        grn_obj_unlink( ctx, col );
+    else if( len > GRN_TABLE_MAX_KEY_SIZE ){
+        LGRN_PROBE3( resolve__return, "column", name, GRN_ID_NIL );
+        lua_pushnil( L );
         return 1;
     }
-    // alloc lgrn_col_t
-    else if( ( c = lua_newuserdata( L, sizeof( lgrn_col_t ) ) ) ){
-        lstate_setmetatable( L, GROONGA_COLUMN_MT );
-        // retain references
-        lgrn_col_init( c, t, col, lstate_refat( L, 1 ) );
-        
-        return 1;
+    // pseudo column such as _key, _id and _value is an accessor that has 
+    // no id. it is not cached.
+    else if( !( id = column_id( ctx, t, name, len, &col ) ) )
+    {
+        LGRN_PROBE3( resolve__return, "column", name, GRN_ID_NIL );
+        if( !col && 
+            !( col = grn_obj_column( ctx, t->tbl, name, (unsigned int)len ) ) ){
+            lua_pushnil( L );
+            return 1;
+        }
+        else if( push_accessor( L, t, col ) ){
+            return 1;
+        }
+        lua_pushnil( L );
+        lua_pushstring( L, strerror( errno ) );
+        return 2;
     }
     
-    // nomem error
-    grn_obj_unlink( ctx, col );
-    lua_pushnil( L );
-    lua_pushstring( L, strerror( errno ) );
+    switch( push_column( L, t, 1, id, col ) ){
+        case 1:
+            LGRN_PROBE3( resolve__return, "column", name, id );
+            resolved_set( L, t );
+            return 1;
+        case 0:
+            LGRN_PROBE3( resolve__return, "column", name, GRN_ID_NIL );
+            lua_pushnil( L );
+            return 1;
+        // nomem error
+        default:
+            lua_pushnil( L );
+            lua_pushstring( L, strerror( errno ) );
+            return 2;
+    }
+}
+
+
+static int column_lua( lua_State *L )
+{
+    lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
     
-    return 2;
+    return lgrn_stats_measure( L, t->g, LGRN_OP_COLUMN, get_column( L ) );
+}
+
+
+// retarget a reusable column object to the column of id.
+// returns 0 if column does not exist.
+static int retarget_column( lgrn_tbl_t *t, lgrn_col_t *c, grn_id id )
+{
+    grn_ctx *ctx = lgrn_get_ctx( t->g );
+    grn_obj *col = grn_ctx_at( ctx, id );
+    
+    if( !col ){
+        return 0;
+    }
+    // release previous target
+    else if( c->col && !c->removed ){
+        grn_obj_unlink( ctx, c->col );
+    }
+    lgrn_col_init( c, t, col, c->ref_t );
+    c->light = 1;
+    
+    return 1;
 }
 
 
 static int columns_next_lua( lua_State *L )
 {
     lgrn_tbl_t *t = luaL_checkudata( L, lua_upvalueindex( 1 ), MODULE_MT );
-    int with_obj = lua_toboolean( L, lua_upvalueindex( 2 ) );
-    col_iter_t *it = lua_touserdata( L, lua_upvalueindex( 3 ) );
-    int rv = 0;
+    int mode = (int)lua_tointeger( L, lua_upvalueindex( 2 ) );
+    int catalog = lua_upvalueindex( 3 );
+    int idx = (int)lua_tointeger( L, lua_upvalueindex( 4 ) );
+    int n = 0;
+    grn_id id = GRN_ID_NIL;
     
+    LGRN_PROBE2( iter__next, "columns", idx );
     if( IS_REMOVED( t ) ){
         lua_pushnil( L );
         lua_pushstring( L, LGRN_ENOTABLE );
-        rv = 2;
+        return 2;
     }
-    else
+    
+    lua_rawgeti( L, catalog, 0 );
+    n = (int)lua_tointeger( L, -1 );
+    lua_pop( L, 1 );
+    
+    while( idx < n )
     {
-        lgrn_col_t *c = NULL;
-        grn_obj *col = NULL;
-        lgrn_objname_t oname;
-        int rc = 0;
-         
-        while( ( rc = col_iter_next( it, &col ) ) == GRN_SUCCESS )
+        // update index
+        idx++;
+        lua_pushinteger( L, idx );
+        lua_replace( L, lua_upvalueindex( 4 ) );
+        
+        // push column name
+        lua_rawgeti( L, catalog, idx );
+        // return name
+        if( mode == LGRN_ITER_NAME ){
+            return 1;
+        }
+        
+        // get column id
+        lua_pushvalue( L, -1 );
+        lua_rawget( L, catalog );
+        // return name and id
+        if( mode == LGRN_ITER_ID ){
+            return 2;
+        }
+        
+        id = (grn_id)lua_tointeger( L, -1 );
+        lua_pop( L, 1 );
+        if( mode == LGRN_ITER_LIGHT )
         {
-            // push column name
-            oname.len = grn_column_name( it->ctx, col, oname.name, 
-                                         GRN_TABLE_MAX_KEY_SIZE );
-            lua_pushlstring( L, oname.name, (size_t)oname.len );
-            
-            // return name
-            if( !with_obj ){
-                return 1;
-            }
-            // lookup from weak reference
-            else if( lgrn_refget_col( L, oname.name, (size_t)oname.len ) ){
-                grn_obj_unlink( it->ctx, col );
+            // use the cached object if exists
+            if( refget_col( L, t->g, id ) ){
                 return 2;
             }
-            // create table metatable
-            else if( ( c = lua_newuserdata( L, sizeof( lgrn_col_t ) ) ) ){
-                lstate_setmetatable( L, GROONGA_COLUMN_MT );
-                // save reference
-                lgrn_refset_col( L, oname.name, (size_t)oname.len, -1 );
-                // init fields
-                lgrn_col_init( 
-                    c, t, col, lstate_refat( L, lua_upvalueindex( 1 ) )
-                );
-                
+            else if( retarget_column( t, 
+                                      lua_touserdata( L, 
+                                                      lua_upvalueindex( 5 ) ),
+                                      id ) ){
+                lua_pushvalue( L, lua_upvalueindex( 5 ) );
                 return 2;
             }
-            
-            // nomem error
-            grn_obj_unlink( it->ctx, col );
-            lua_pushnil( L );
-            lua_pushstring( L, strerror( errno ) );
-            rv = 2;
+            // column has been removed
+            lua_pop( L, 1 );
+            continue;
         }
         
-        if( rc != GRN_SUCCESS && rc != GRN_END_OF_DATA ){
-            lua_pushnil( L );
-            lua_pushstring( L, strerror( errno ) );
-            rv = 2;
+        switch( push_column( L, t, lua_upvalueindex( 1 ), id, NULL ) ){
+            case 1:
+                return 2;
+            // column has been removed
+            case 0:
+                lua_pop( L, 1 );
+                break;
+            // nomem error
+            default:
+                lua_pushnil( L );
+                lua_pushstring( L, strerror( errno ) );
+                return 2;
         }
     }
     
-    col_iter_dispose( it );
+    LGRN_PROBE2( iter__return, "columns", idx );
     
-    return rv;
+    return 0;
 }
 
 
 static int columns_lua( lua_State *L )
 {
     lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
-    grn_ctx *ctx = NULL;
-    int with_obj = 0;
-    col_iter_t *it = NULL;
+    int mode = lgrn_iter_mode( L, 2 );
     
     CHECK_EXISTS( L, t );
-    ctx = lgrn_get_ctx( t->g );
     
     // check argument
-    if( lua_type( L, 2 ) == LUA_TBOOLEAN ){
-        with_obj = lua_toboolean( L, 2 );
+    if( mode == -1 ){
+        return luaL_argerror( L, 2, "invalid mode value" );
     }
     // remove unused stack items
     lua_settop( L, 1 );
-    lua_pushboolean( L, with_obj );
+    CHECK_UNLIGHT( L, t );
+    lua_pushinteger( L, mode );
     
-    // nomem
-    if( !( it = lua_newuserdata( L, sizeof( col_iter_t ) ) ) ){
+    // groonga error
+    if( catalog_push( L, t ) != GRN_SUCCESS ){
         lua_pushnil( L );
-        lua_pushstring( L, strerror( errno ) );
-        return 2;
-    }
-    else if( col_iter_init( it, ctx, t->tbl ) != GRN_SUCCESS ){
-        lua_pushnil( L );
-        lua_pushstring( L, ctx->errbuf );
+        lua_pushstring( L, lgrn_get_ctx( t->g )->errbuf );
         return 2;
     }
+    lua_pushinteger( L, 0 );
+    LGRN_PROBE2( iter__entry, "columns", mode );
     
-    // set metatable
-    lstate_setmetatable( L, ITERATOR_MT );
-    // upvalues: t, with_obj, it
-    lua_pushcclosure( L, columns_next_lua, 3 );
+    // reusable column object that is not cached by the object reference
+    if( mode == LGRN_ITER_LIGHT )
+    {
+        lgrn_col_t *c = lua_newuserdata( L, sizeof( lgrn_col_t ) );
+        
+        if( !c ){
+            lua_pushnil( L );
+            lua_pushstring( L, strerror( errno ) );
+            return 2;
+        }
+        lstate_setmetatable( L, GROONGA_COLUMN_MT );
+        *c = (lgrn_col_t){
+            .t = t,
+            .col = NULL,
+            .id = GRN_ID_NIL,
+            .removed = 1,
+            .light = 1,
+            .ref_t = lstate_refat( L, 1 )
+        };
+        // upvalues: t, mode, catalog, index, col
+        lua_pushcclosure( L, columns_next_lua, 5 );
+    }
+    else {
+        // upvalues: t, mode, catalog, index
+        lua_pushcclosure( L, columns_next_lua, 4 );
+    }
     
     return 1;
 }
 
 
-static int column_create_lua( lua_State *L )
+static int create_column( lua_State *L )
 {
     lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
     grn_ctx *ctx = NULL;
@@ -329,6 +570,8 @@ static int column_create_lua( lua_State *L )
     grn_obj *col = NULL;
     
     CHECK_EXISTS( L, t );
+    CHECK_WRITABLE( L, t );
+    CHECK_UNLIGHT( L, t );
     ctx = lgrn_get_ctx( t->g );
     
     // check arguments
@@ -354,13 +597,8 @@ static int column_create_lua( lua_State *L )
         }
         
         // valType
-        name = lstate_toptstring( L, "valType", NULL );
-        if( name )
-        {
-            id = lgrn_n2i_data( L, name );
-            if( id == -1 || !( vtype = grn_ctx_at( ctx, (grn_id)id ) ) ){
-                return luaL_argerror( L, 2, "invalid valType value" );
-            }
+        if( lgrn_type_opt( L, t->g, "valType", &vtype ) == -1 ){
+            return luaL_argerror( L, 2, "invalid valType value" );
         }
         
         // compress
@@ -446,9 +684,10 @@ static int column_create_lua( lua_State *L )
         if( ( col = grn_column_create( ctx, t->tbl, name, 
                                        (unsigned int)len, path, flags,
                                        vtype ) ) ){
+            lgrn_schema_changed( t->g );
             lstate_setmetatable( L, GROONGA_COLUMN_MT );
             // save reference
-            lgrn_refset_col( L, name, len, -1 );
+            lgrn_refset_obj( L, t->g, grn_obj_id( ctx, col ), -1 );
             // init fields
             lgrn_col_init( c, t, col, lstate_refat( L, 1 ) );
             
@@ -469,6 +708,14 @@ static int column_create_lua( lua_State *L )
 }
 
 
+static int column_create_lua( lua_State *L )
+{
+    lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
+    
+    return lgrn_stats_measure( L, t->g, LGRN_OP_DDL, create_column( L ) );
+}
+
+
 // MARK: table API
 static int name_lua( lua_State *L )
 {
@@ -529,9 +776,7 @@ static int key_type_lua( lua_State *L )
         lua_pushnil( L );
     }
     else {
-        size_t len = 0;
-        const char *name = lgrn_i2n_data( L, (int)t->tbl->header.domain, &len );
-        lua_pushlstring( L, name, len );
+        lgrn_type_push( L, t->g, t->tbl->header.domain );
     }
     
     return 1;
@@ -546,9 +791,7 @@ static int val_type_lua( lua_State *L )
     CHECK_EXISTS( L, t );
     id = grn_obj_get_range( lgrn_get_ctx( t->g ), t->tbl );
     if( id != GRN_ID_NIL ){
-        size_t len = 0;
-        const char *name = lgrn_i2n_data( L, (int)id, &len );
-        lua_pushlstring( L, name, len );
+        lgrn_type_push( L, t->g, id );
     }
     else {
         lua_pushnil( L );
@@ -591,6 +834,74 @@ static int normalize_lua( lua_State *L )
 }
 
 
+// push a name of procedure, or a nil if proc is NULL
+static void push_procname( lua_State *L, grn_ctx *ctx, grn_obj *proc )
+{
+    lgrn_objname_t oname;
+    
+    if( proc && lgrn_get_objname( &oname, ctx, proc ) ){
+        lua_pushlstring( L, oname.name, (size_t)oname.len );
+    }
+    else {
+        lua_pushnil( L );
+    }
+}
+
+
+static int tokenizer_lua( lua_State *L )
+{
+    lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
+    
+    CHECK_EXISTS( L, t );
+    ctx = lgrn_get_ctx( t->g );
+    push_procname( L, ctx, grn_obj_get_info( ctx, t->tbl, 
+                                             GRN_INFO_DEFAULT_TOKENIZER, 
+                                             NULL ) );
+    
+    return 1;
+}
+
+
+static int normalizer_lua( lua_State *L )
+{
+    lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
+    
+    CHECK_EXISTS( L, t );
+    ctx = lgrn_get_ctx( t->g );
+    push_procname( L, ctx, grn_obj_get_info( ctx, t->tbl, GRN_INFO_NORMALIZER, 
+                                             NULL ) );
+    
+    return 1;
+}
+
+
+static int token_filters_lua( lua_State *L )
+{
+    lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
+    grn_obj filters;
+    size_t n = 0;
+    size_t i = 0;
+    
+    CHECK_EXISTS( L, t );
+    ctx = lgrn_get_ctx( t->g );
+    GRN_PTR_INIT( &filters, GRN_OBJ_VECTOR, GRN_ID_NIL );
+    grn_obj_get_info( ctx, t->tbl, GRN_INFO_TOKEN_FILTERS, &filters );
+    n = GRN_BULK_VSIZE( &filters ) / sizeof( grn_obj* );
+    
+    lua_createtable( L, (int)n, 0 );
+    for(; i < n; i++ ){
+        push_procname( L, ctx, GRN_PTR_VALUE_AT( &filters, i ) );
+        lua_rawseti( L, -2, (int)i + 1 );
+    }
+    GRN_OBJ_FIN( ctx, &filters );
+    
+    return 1;
+}
+
+
 static int db_lua( lua_State *L )
 {
     lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
@@ -603,21 +914,107 @@ static int db_lua( lua_State *L )
 }
 
 
-static int remove_lua( lua_State *L )
+static int lock_lua( lua_State *L )
+{
+    lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
+    int timeout = (int)luaL_optinteger( L, 2, grn_get_lock_timeout() );
+    grn_ctx *ctx = NULL;
+    
+    CHECK_EXISTS_EX( L, t, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, t, CHECK_RET_FALSE );
+    ctx = lgrn_get_ctx( t->g );
+    if( grn_obj_lock( ctx, t->tbl, GRN_ID_NIL, timeout ) != GRN_SUCCESS ){
+        lua_pushboolean( L, 0 );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+static int unlock_lua( lua_State *L )
 {
     lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
     
     CHECK_EXISTS_EX( L, t, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, t, CHECK_RET_FALSE );
+    ctx = lgrn_get_ctx( t->g );
+    if( grn_obj_unlock( ctx, t->tbl, GRN_ID_NIL ) != GRN_SUCCESS ){
+        lua_pushboolean( L, 0 );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+static int is_locked_lua( lua_State *L )
+{
+    lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
+    
+    CHECK_EXISTS_EX( L, t, CHECK_RET_FALSE );
+    lua_pushboolean( L, grn_obj_is_locked( lgrn_get_ctx( t->g ), t->tbl ) );
+    
+    return 1;
+}
+
+
+// force clear a lock
+static int clear_lock_lua( lua_State *L )
+{
+    lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
+    grn_ctx *ctx = NULL;
+    
+    CHECK_EXISTS_EX( L, t, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, t, CHECK_RET_FALSE );
+    ctx = lgrn_get_ctx( t->g );
+    if( grn_obj_clear_lock( ctx, t->tbl ) != GRN_SUCCESS ){
+        lua_pushboolean( L, 0 );
+        lua_pushstring( L, ctx->errbuf );
+        return 2;
+    }
+    lua_pushboolean( L, 1 );
+    
+    return 1;
+}
+
+
+static int remove_table( lua_State *L )
+{
+    lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
+    lgrn_tbl_t *light = t;
+    
+    CHECK_EXISTS_EX( L, t, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, t, CHECK_RET_FALSE );
+    // remove through the cached object to mark it as removed
+    CHECK_UNLIGHT_EX( L, t, CHECK_RET_FALSE );
     grn_obj_remove( lgrn_get_ctx( t->g ), t->tbl );
+    lgrn_refdel_obj( L, t->g, t->id );
+    lgrn_schema_changed( t->g );
     t->removed = 1;
     t->tbl = NULL;
+    light->removed = 1;
+    light->tbl = NULL;
     lua_pushboolean( L, 1 );
     
     return 1;
 }
 
 
-static int rename_lua( lua_State *L )
+static int remove_lua( lua_State *L )
+{
+    lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
+    
+    return lgrn_stats_measure( L, t->g, LGRN_OP_DDL, remove_table( L ) );
+}
+
+
+static int rename_table( lua_State *L )
 {
     lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
     grn_ctx *ctx = NULL;
@@ -625,6 +1022,7 @@ static int rename_lua( lua_State *L )
     const char *name = NULL;
     
     CHECK_EXISTS_EX( L, t, CHECK_RET_FALSE );
+    CHECK_WRITABLE_EX( L, t, CHECK_RET_FALSE );
     ctx = lgrn_get_ctx( t->g );
     name = luaL_checklstring( L, 2, &len );
     
@@ -640,6 +1038,7 @@ static int rename_lua( lua_State *L )
         lua_pushfstring( L, ctx->errbuf );
         return 1;
     }
+    lgrn_schema_changed( t->g );
     
     lua_pushboolean( L, 1 );
     
@@ -647,6 +1046,14 @@ static int rename_lua( lua_State *L )
 }
 
 
+static int rename_lua( lua_State *L )
+{
+    lgrn_tbl_t *t = luaL_checkudata( L, 1, MODULE_MT );
+    
+    return lgrn_stats_measure( L, t->g, LGRN_OP_DDL, rename_table( L ) );
+}
+
+
 static int tostring_lua( lua_State *L )
 {
     return lgrn_tostring( L, MODULE_MT );
@@ -662,6 +1069,8 @@ static int gc_lua( lua_State *L )
     }
     // release reference
     lstate_unref( L, t->ref_g );
+    lstate_unref( L, t->ref_cols );
+    lstate_unref( L, t->ref_catalog );
 
     return 0;
 }
@@ -677,6 +1086,10 @@ LUALIB_API int luaopen_groonga_table( lua_State *L )
     struct luaL_Reg methods[] = {
         { "rename", rename_lua },
         { "remove", remove_lua },
+        { "lock", lock_lua },
+        { "unlock", unlock_lua },
+        { "isLocked", is_locked_lua },
+        { "clearLock", clear_lock_lua },
         { "db", db_lua },
         { "name", name_lua },
         { "path", path_lua },
@@ -686,6 +1099,9 @@ LUALIB_API int luaopen_groonga_table( lua_State *L )
         { "persistent", persistent_lua },
         { "withSIS", with_sis_lua },
         { "normalize", normalize_lua },
+        { "tokenizer", tokenizer_lua },
+        { "normalizer", normalizer_lua },
+        { "tokenFilters", token_filters_lua },
         { "column", column_lua },
         { "columns", columns_lua },
         { "columnCreate", column_create_lua },
@@ -693,7 +1109,6 @@ LUALIB_API int luaopen_groonga_table( lua_State *L )
     };
     
     lgrn_register_mt( L, MODULE_MT, mmethods, methods );
-    col_iter_init_mt( L );
     
     return 0;
 }
@@ -32,8 +32,6 @@
 #define MODULE_MT   "groonga.weak_reference"
 
 static int REF_WEAK_DB;
-static int REF_WEAK_TABLE;
-static int REF_WEAK_COLUMN;
 
 
 static int getref( lua_State *L, int ref, const char *name, size_t len )
@@ -87,27 +85,141 @@ void lgrn_refset_db( lua_State *L, const char *name, size_t len, int idx )
     setref( L, REF_WEAK_DB, name, len, idx );
 }
 
-// table reference
-int lgrn_refget_tbl( lua_State *L, const char *name, size_t len )
+void lgrn_refpush_db( lua_State *L )
 {
-    return getref( L, REF_WEAK_TABLE, name, len );
+    lstate_pushref( L, REF_WEAK_DB );
 }
 
-void lgrn_refset_tbl( lua_State *L, const char *name, size_t len, int idx )
+// object reference of database
+int lgrn_refnew_obj( lua_State *L )
 {
-    setref( L, REF_WEAK_TABLE, name, len, idx );
+    lua_newtable( L );
+    lstate_setmetatable( L, MODULE_MT );
+    return lstate_ref( L );
 }
 
+int lgrn_refget_obj( lua_State *L, lgrn_t *g, grn_id id, const char *tname )
+{
+    lstate_pushref( L, g->ref_objs );
+    lua_rawgeti( L, -1, (int)id );
+    
+    // found
+    if( lua_getmetatable( L, -1 ) )
+    {
+        // check a type of object
+        luaL_getmetatable( L, tname );
+        if( lua_rawequal( L, -1, -2 ) ){
+            lua_pop( L, 2 );
+            lua_replace( L, -2 );
+            return 1;
+        }
+        lua_pop( L, 2 );
+    }
+    
+    // not found
+    lua_pop( L, 2 );
+    
+    return 0;
+}
 
-// column reference
-int lgrn_refget_col( lua_State *L, const char *name, size_t len )
+void lgrn_refset_obj( lua_State *L, lgrn_t *g, grn_id id, int idx )
 {
-    return getref( L, REF_WEAK_COLUMN, name, len );
+    // convert to unsigned index
+    if( idx < 0 ){
+        idx = lua_gettop( L ) + idx + 1;
+    }
+    
+    lstate_pushref( L, g->ref_objs );
+    lua_pushvalue( L, idx );
+    lua_rawseti( L, -2, (int)id );
+    lua_pop( L, 1 );
 }
 
-void lgrn_refset_col( lua_State *L, const char *name, size_t len, int idx )
+void lgrn_refdel_obj( lua_State *L, lgrn_t *g, grn_id id )
 {
-    setref( L, REF_WEAK_COLUMN, name, len, idx );
+    lstate_pushref( L, g->ref_objs );
+    lua_pushnil( L );
+    lua_rawseti( L, -2, (int)id );
+    lua_pop( L, 1 );
+}
+
+
+// check the object of id is still same as the object of handle
+static int obj_alive( grn_ctx *ctx, grn_id id, grn_obj *obj, int istbl, 
+                      int tmp )
+{
+    grn_obj *cur = NULL;
+    
+    // temporary object is not removed by the command, but it is closed 
+    // with the context
+    if( id & GRN_OBJ_TMP_OBJECT ){
+        return !tmp;
+    }
+    else if( tmp ){
+        return 1;
+    }
+    else if( !( cur = grn_ctx_at( ctx, id ) ) ){
+        return 0;
+    }
+    // id has been reused by other object
+    else if( cur != obj || lgrn_obj_istbl( cur ) != istbl ){
+        grn_obj_unlink( ctx, cur );
+        return 0;
+    }
+    
+    return 1;
+}
+
+
+void lgrn_refsweep_obj( lua_State *L, lgrn_t *g, int tmp )
+{
+    grn_ctx *ctx = lgrn_get_ctx( g );
+    int objs = 0;
+    
+    lstate_pushref( L, g->ref_objs );
+    objs = lua_gettop( L );
+    luaL_getmetatable( L, GROONGA_TABLE_MT );
+    luaL_getmetatable( L, GROONGA_COLUMN_MT );
+    
+    lua_pushnil( L );
+    while( lua_next( L, objs ) )
+    {
+        grn_id id = (grn_id)lua_tointeger( L, -2 );
+        void *udata = lua_touserdata( L, -1 );
+        int alive = 1;
+        
+        if( udata && lua_getmetatable( L, -1 ) )
+        {
+            if( lua_rawequal( L, -1, objs + 1 ) ){
+                lgrn_tbl_t *t = (lgrn_tbl_t*)udata;
+                
+                if( !t->removed && 
+                    !( alive = obj_alive( ctx, id, t->tbl, 1, tmp ) ) ){
+                    t->removed = 1;
+                    t->tbl = NULL;
+                }
+            }
+            else if( lua_rawequal( L, -1, objs + 2 ) ){
+                lgrn_col_t *c = (lgrn_col_t*)udata;
+                
+                if( !c->removed && 
+                    !( alive = obj_alive( ctx, id, c->col, 0, tmp ) ) ){
+                    c->removed = 1;
+                    c->col = NULL;
+                }
+            }
+            lua_pop( L, 1 );
+        }
+        lua_pop( L, 1 );
+        
+        // assigning nil to the existing field is allowed while traversal
+        if( !alive ){
+            lua_pushvalue( L, -1 );
+            lua_pushnil( L );
+            lua_rawset( L, objs );
+        }
+    }
+    lua_settop( L, objs - 1 );
 }
 
 
@@ -122,16 +234,6 @@ void lgrn_weakref_init( lua_State *L )
     lua_newtable( L );
     lstate_setmetatable( L, MODULE_MT );
     REF_WEAK_DB = lstate_ref( L );
-    
-    // create weak reference table for tables
-    lua_newtable( L );
-    lstate_setmetatable( L, MODULE_MT );
-    REF_WEAK_TABLE = lstate_ref( L );
-    
-    // create weak reference table for columns
-    lua_newtable( L );
-    lstate_setmetatable( L, MODULE_MT );
-    REF_WEAK_COLUMN = lstate_ref( L );
 }
 
 
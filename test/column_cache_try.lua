@@ -0,0 +1,43 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local spec = {
+    name = 'testColumn',
+    type ='SCALAR',
+    valType = 'UINT32',
+    persistent = true
+};
+local t, c;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+t = ifNil( g:tableCreate({ name = 'test' }) );
+ifNotNil( t:column('testColumn') );
+c = ifNil( t:columnCreate( spec ) );
+
+-- resolved column
+ifNotEqual( c, t:column('testColumn') );
+ifNotEqual( c, t:column('testColumn') );
+
+-- rename
+ifNotTrue( c:rename('renamed') );
+ifNotNil( t:column('testColumn') );
+ifNotEqual( c, t:column('renamed') );
+
+-- remove
+ifNotTrue( c:remove() );
+ifNotNil( t:column('renamed') );
+
+-- create
+c = ifNil( t:columnCreate( spec ) );
+ifNotEqual( c, t:column('testColumn') );
+
+-- pseudo column
+ifNil( t:column('_key') );
+ifNil( t:column('_id') );
+ifNotEqual( t:column('_key'):name(), '_key' );
+ifNotNil( t:column('_unknown') );
+
+g:remove();
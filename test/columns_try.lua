@@ -40,6 +40,39 @@ for name, col in t:columns() do
     ifNotNil( col );
 end
 
+-- getting all column name with column id
+for name, id in t:columns('id') do
+    ifNil( cols[name] );
+    ifNotEqual( type( id ), 'number' );
+end
+
+-- getting all column name with reusable column obj
+local cached = t:column('test3');
+for name, col in t:columns('light') do
+    ifNil( cols[name] );
+    ifNotEqual( col:name(), name );
+    -- cached column obj is returned as is
+    if name == 'test3' then
+        ifNotEqual( col, cached );
+    end
+end
+cached = nil;
+
+-- removed through reusable column obj
+ifNil( t:columnCreate({ name = 'tmp', valType = 'UINT32', persistent = true }) );
+collectgarbage();
+for name, col in t:columns('light') do
+    if name == 'tmp' then
+        cached = ifNil( t:column('tmp') );
+        ifEqual( col, cached );
+        ifNotTrue( col:remove() );
+        ifNotNil( col:name() );
+    end
+end
+ifNotNil( cached:name() );
+ifNotNil( t:column('tmp') );
+cached = nil;
+
 -- getting all column name with column obj
 for name, col in t:columns(true) do
     ifNil( cols[name] );
@@ -51,4 +84,14 @@ for name, col in t:columns(true) do
 end
 ifNotEqual( nelts, 0 );
 
+-- column list should be updated after the schema changed
+ifNotTrue( t:column('test1'):rename('renamed') );
+ifNotTrue( t:column('test2'):remove() );
+for name in t:columns() do
+    cols[name] = true;
+end
+ifNil( cols.renamed );
+ifNotNil( cols.test1 );
+ifNotNil( cols.test2 );
+
 g:remove();
@@ -0,0 +1,59 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local t, c, ok, stat, values;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+ifNil( g:execute('table_create Docs TABLE_HASH_KEY ShortText') );
+t = ifNil( g:table('Docs') );
+ifNil( t:columnCreate({
+    name = 'size',
+    valType = 'UINT32',
+    persistent = true
+}) );
+for _, compress in ipairs({ 'ZLIB', 'LZ4', 'ZSTD' }) do
+    -- groonga may not support zstd
+    ok, c = pcall( t.columnCreate, t, {
+        name = compress,
+        valType = 'TEXT',
+        persistent = true,
+        compress = compress
+    });
+    if compress ~= 'ZSTD' or ok then
+        ifNil( c );
+        ifNotEqual( c:compress(), compress );
+    end
+end
+
+values = {};
+for i = 1, 100 do
+    values[i] = string.format( '{"_key":"doc%d","ZLIB":"%s","LZ4":"%s"}',
+                               i, string.rep( 'x', 1000 ),
+                               string.rep( 'y', 1000 ) );
+end
+ifNil( g:execute( 'load --table Docs --values \'[' ..
+                  table.concat( values, ',' ) .. ']\'' ) );
+
+-- all records
+for _, name in ipairs({ 'ZLIB', 'LZ4' }) do
+    stat = ifNil( t:column( name ):compressionStats() );
+    ifNotEqual( stat.records, 100 );
+    ifNotEqual( stat.rawBytes, 100 * 1000 );
+    ifNotEqual( stat.estimated, false );
+    ifNotEqual( type( stat.storedBytes ), 'number' );
+    ifNotEqual( type( stat.decodeTime ), 'number' );
+end
+
+-- limit: rawBytes is estimated for all records
+stat = ifNil( t:column('ZLIB'):compressionStats( 10 ) );
+ifNotEqual( stat.records, 10 );
+ifNotEqual( stat.rawBytes, 100 * 1000 );
+ifNotEqual( stat.estimated, true );
+
+-- fixed size column
+ifNotNil( t:column('size'):compressionStats() );
+
+g:remove();
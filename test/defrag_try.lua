@@ -0,0 +1,52 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local ro, t, c, stat, values;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+ifNil( g:execute('table_create Docs TABLE_HASH_KEY ShortText') );
+ifNil( g:execute('column_create Docs body COLUMN_SCALAR Text') );
+ifNil( g:execute('column_create Docs size COLUMN_SCALAR UInt32') );
+t = ifNil( g:table('Docs') );
+c = ifNil( t:column('body') );
+
+-- update records repeatedly to leave garbage in the segments
+for i = 1, 5 do
+    values = {};
+    for j = 1, 100 do
+        values[j] = string.format( '{"_key":"doc%d","body":"%s","size":%d}',
+                                   j, string.rep( 'x', 1000 * i ), i );
+    end
+    ifNil( g:execute( 'load --table Docs --values \'[' ..
+                      table.concat( values, ',' ) .. ']\'' ) );
+end
+
+-- column
+ifNotEqual( type( ifNil( c:defrag() ) ), 'number' );
+ifNotEqual( ifNil( t:column('size'):defrag() ), 0 );
+ifTrue( pcall( c.defrag, c, -1 ) );
+
+-- database
+stat = ifNil( g:defrag({ threshold = 1 }) );
+ifNotEqual( type( stat.segments ), 'number' );
+ifNotEqual( stat.columns, 1 );
+ifNotTrue( stat.done );
+
+-- incremental
+ifNil( g:execute('column_create Docs note COLUMN_SCALAR Text') );
+stat = ifNil( g:defrag({ budget = 1 }) );
+ifNotEqual( type( stat.done ), 'boolean' );
+while not stat.done do
+    stat = ifNil( g:defrag({ budget = 1 }) );
+end
+ifTrue( pcall( g.defrag, g, { budget = -1 } ) );
+
+-- read-only
+ro = ifNil( groonga.new( path, { readonly = true } ) );
+ifNotNil( ro:defrag() );
+ifNotNil( ro:table('Docs'):column('body'):defrag() );
+
+g:remove();
@@ -0,0 +1,47 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local outs, errs;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+
+-- execute commands
+outs, errs = g:executeBatch({
+    'table_create Users TABLE_HASH_KEY ShortText',
+    'load --table Users --values \'[{"_key":"alice"}]\'',
+    'select Users'
+});
+ifNotNil( errs );
+ifNotEqual( #outs, 3 );
+ifNil( outs[3]:find( 'alice', 1, true ) );
+ifNil( g:table('Users') );
+
+-- stop on error
+outs, errs = g:executeBatch({
+    'select Users',
+    'unknown_command',
+    'select Users'
+});
+ifNil( errs );
+ifNotEqual( type( outs[1] ), 'string' );
+ifNotEqual( outs[2], false );
+ifNil( errs[2] );
+ifNotNil( outs[3] );
+
+-- continue on error
+outs, errs = g:executeBatch({
+    'select Users',
+    'unknown_command',
+    'select Users'
+}, { stopOnError = false });
+ifNil( errs );
+ifNotEqual( outs[2], false );
+ifNotEqual( outs[3], outs[1] );
+
+-- invalid command list
+ifTrue( pcall( g.executeBatch, g, { 'select Users', 1 } ) );
+
+g:remove();
@@ -0,0 +1,83 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local ro, out, err, chunks;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+
+-- DDL
+out = ifNil( g:execute('table_create Users TABLE_HASH_KEY ShortText') );
+ifNotEqual( type( out ), 'string' );
+ifNil( g:table('Users') );
+ifNil( g:execute('column_create Users age COLUMN_SCALAR UInt32') );
+ifNil( g:table('Users'):column('age') );
+
+-- load and select
+ifNil( g:execute('load --table Users --values \'[{"_key":"alice","age":20}]\'') );
+out = ifNil( g:execute('select Users --output_columns _key,age') );
+ifNil( out:find( 'alice', 1, true ) );
+
+-- schema change invalidates the resolved columns
+ifNil( g:execute('column_create Users tmp COLUMN_SCALAR UInt32') );
+ifNil( g:table('Users'):column('tmp') );
+ifNil( g:execute('/d/column_remove?table=Users&name=tmp') );
+ifNotNil( g:table('Users'):column('tmp') );
+
+-- objects removed by a command are marked as removed
+local tmp;
+ifNil( g:execute('table_create Tmp TABLE_HASH_KEY ShortText') );
+ifNil( g:execute('column_create Tmp val COLUMN_SCALAR UInt32') );
+tmp = ifNil( g:table('Tmp') );
+local val = ifNil( tmp:column('val') );
+ifNil( g:execute('table_remove Tmp') );
+ifNotNil( tmp:name() );
+ifNotNil( val:name() );
+ifNotNil( g:table('Tmp') );
+ifNil( g:execute('table_create Tmp TABLE_HASH_KEY ShortText') );
+ifEqual( g:table('Tmp'), tmp );
+
+-- streaming output
+chunks = {};
+ifNotTrue( g:execute( 'select Users', {
+    onChunk = function( chunk )
+        chunks[#chunks + 1] = chunk;
+    end
+}) );
+ifNotEqual( table.concat( chunks ), g:execute('select Users') );
+
+-- callback error
+out, err = g:execute( 'select Users', {
+    onChunk = function()
+        error('callback error');
+    end
+});
+ifNotNil( out );
+ifNil( err );
+
+-- binary output
+out = ifNil( g:execute( 'select Users', { outputType = 'MSGPACK' } ) );
+ifEqual( out:sub( 1, 1 ), '[' );
+-- output type should not be kept
+out = ifNil( g:execute('select Users') );
+ifNotEqual( out:sub( 1, 1 ), '[' );
+ifTrue( pcall( g.execute, g, 'select Users', { outputType = 'UNKNOWN' } ) );
+
+-- invalid command
+out, err = g:execute('unknown_command');
+ifNotNil( out );
+ifNil( err );
+
+-- read-only database accepts read commands only
+g:flush();
+ro = ifNil( groonga.new( path, { readonly = true } ) );
+ifNil( ro:execute('/d/select?table=Users') );
+out, err = ro:execute('table_remove Users');
+ifNotNil( out );
+ifNil( err );
+ifNil( ro:table('Users') );
+ro = nil;
+
+g:remove();
@@ -0,0 +1,36 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local t;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+t = ifNil( g:tableCreate({ name = 'test' }) );
+
+-- flush
+ifNotTrue( g:flush() );
+ifNotTrue( g:flush({ recursive = false }) );
+
+-- auto flush
+ifNotTrue( g:autoFlush({ writes = 2, interval = 100 }) );
+for i = 1, 10 do
+    ifNil( t:columnCreate({
+        name = 'test' .. i,
+        type ='SCALAR',
+        valType = 'UINT32',
+        persistent = true
+    }) );
+end
+-- change policy
+ifNotTrue( g:autoFlush({ interval = 10 }) );
+-- disable auto flush
+ifNotTrue( g:autoFlush( false ) );
+ifNotTrue( g:autoFlush() );
+-- invalid arguments
+ifTrue( pcall( g.autoFlush, g, { writes = -1 } ) );
+ifTrue( pcall( g.autoFlush, g, true ) );
+
+ifNotTrue( g:autoFlush({ writes = 1 }) );
+g:remove();
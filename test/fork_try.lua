@@ -0,0 +1,58 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+ifNil( g:tableCreate({ name = 'test' }) );
+local tmp = ifNil( g:tableCreate() );
+ifNotTrue( g:autoFlush({ writes = 1, interval = 10 }) );
+
+-- hooks should be callable in the same process
+ifNotTrue( groonga.prefork() );
+ifNotTrue( groonga.postfork() );
+
+-- database should be reused
+ifNotEqual( g, groonga.new( path ) );
+ifNil( g:table('test') );
+
+-- fork requires luaposix.
+-- NOTE: the reinitialization in the child process is NOT verified if
+-- luaposix is not installed.
+local ok, unistd = pcall( require, 'posix.unistd' );
+if ok then
+    local wait = require('posix.sys.wait');
+    local pid, reason, status;
+
+    ifNotTrue( groonga.prefork() );
+    pid = ifNil( unistd.fork() );
+    if pid == 0 then
+        -- reinitialize in the child process and write to the database
+        local rc = 1;
+        -- temporary table is closed by the reinitialization
+        if groonga.postfork() and groonga.new( path ) == g and
+           g:table('test') and tmp:type() == nil and
+           g:execute('load --table test --values \'[{}]\'') then
+            rc = 0;
+        end
+        unistd._exit( rc );
+    end
+
+    ifNotTrue( groonga.postfork() );
+    pid, reason, status = wait.wait( pid );
+    ifNotEqual( reason, 'exited' );
+    ifNotEqual( status, 0 );
+
+    -- auto flush should be restarted in the parent process
+    ifNil( g:execute('load --table test --values \'[{}]\'') );
+    -- temporary table should be kept in the parent process
+    ifNil( tmp:type() );
+else
+    io.stderr:write(
+        'WARNING: fork is NOT verified: luaposix is not installed\n'
+    );
+end
+
+g:remove();
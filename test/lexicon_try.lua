@@ -0,0 +1,69 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local t, filters, out;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+ifNil( g:execute('plugin_register token_filters/stop_word') );
+
+-- lexicon options
+t = ifNil( g:tableCreate({
+    name = 'Terms',
+    type = 'PAT_KEY',
+    keyType = 'SHORT_TEXT',
+    tokenizer = 'TokenBigram',
+    normalizer = 'NormalizerAuto',
+    tokenFilters = { 'TokenFilterStopWord' }
+}) );
+ifNotEqual( t:tokenizer(), 'TokenBigram' );
+ifNotEqual( t:normalizer(), 'NormalizerAuto' );
+filters = ifNil( t:tokenFilters() );
+ifNotEqual( #filters, 1 );
+ifNotEqual( filters[1], 'TokenFilterStopWord' );
+
+-- temporary lexicon
+t = ifNil( g:tableCreate({
+    type = 'PAT_KEY',
+    keyType = 'SHORT_TEXT',
+    tokenizer = 'TokenBigram',
+    normalizer = 'NormalizerAuto'
+}) );
+ifNotNil( t:name() );
+ifTrue( t:persistent() );
+ifNotEqual( t:tokenizer(), 'TokenBigram' );
+ifNotEqual( t:normalizer(), 'NormalizerAuto' );
+
+-- default
+t = ifNil( g:tableCreate({ name = 'Keys', type = 'HASH_KEY', keyType = 'SHORT_TEXT' }) );
+ifNotNil( t:tokenizer() );
+ifNotNil( t:normalizer() );
+ifNotEqual( #t:tokenFilters(), 0 );
+
+-- invalid procedures
+for _, opt in ipairs({
+    { tokenizer = 'NormalizerAuto' },
+    { normalizer = 'TokenBigram' },
+    { tokenFilters = { 'TokenBigram' } },
+    { tokenFilters = 'TokenFilterStopWord' }
+}) do
+    opt.name = 'Invalid';
+    opt.type = 'PAT_KEY';
+    opt.keyType = 'SHORT_TEXT';
+    ifTrue( pcall( g.tableCreate, g, opt ) );
+end
+ifNotNil( g:table('Invalid') );
+
+-- index that built by the lexicon
+ifNil( g:execute('table_create Docs TABLE_NO_KEY') );
+ifNil( g:execute('column_create Docs body COLUMN_SCALAR Text') );
+ifNil( g:execute('column_create Terms is_stop_word COLUMN_SCALAR Bool') );
+ifNil( g:execute('load --table Terms --values \'[{"_key":"the","is_stop_word":true}]\'') );
+ifNil( g:execute('column_create Terms index COLUMN_INDEX|WITH_POSITION Docs body') );
+ifNil( g:execute('load --table Docs --values \'[{"body":"Groonga"}]\'') );
+out = ifNil( g:execute('select Docs --match_columns body --query groonga') );
+ifNil( out:find( 'Groonga', 1, true ) );
+
+g:remove();
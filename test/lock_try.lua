@@ -0,0 +1,32 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local t, c;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+t = ifNil( g:tableCreate({ name = 'test' }) );
+c = ifNil( t:columnCreate({
+    name = 'testColumn',
+    type ='SCALAR',
+    valType = 'UINT32',
+    persistent = true
+}) );
+
+for _, obj in ipairs({ g, t, c }) do
+    ifTrue( obj:isLocked() );
+    ifNotTrue( obj:lock( 100 ) );
+    ifNotTrue( obj:isLocked() );
+    -- lock should be timed out
+    ifTrue( obj:lock( 0 ) );
+    ifNotTrue( obj:unlock() );
+    ifTrue( obj:isLocked() );
+    -- clear lock
+    ifNotTrue( obj:lock() );
+    ifNotTrue( obj:clearLock() );
+    ifTrue( obj:isLocked() );
+end
+
+g:remove();
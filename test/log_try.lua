@@ -0,0 +1,68 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local logs, ndropped, found, slow;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+ifNil( g:tableCreate({ name = 'test' }) );
+
+-- capture query logs
+ifNotTrue( groonga.captureLog({ level = 'info', query = true }) );
+ifTrue( pcall( groonga.captureLog, { level = 'unknown' } ) );
+ifNil( g:execute('select test') );
+logs, ndropped = groonga.drainLog();
+ifNil( logs );
+ifNotEqual( ndropped, 0 );
+found = false;
+for _, log in ipairs( logs ) do
+    ifNotEqual( type( log.message ), 'string' );
+    if log.type == 'query' and log.message:find( 'select test', 1, true ) then
+        found = true;
+    end
+end
+ifNotTrue( found );
+-- logs should be drained
+logs = groonga.drainLog();
+ifNotEqual( #logs, 0 );
+
+-- restore default loggers
+ifNotTrue( groonga.captureLog( false ) );
+ifNil( g:execute('select test') );
+logs = groonga.drainLog();
+ifNotEqual( #logs, 0 );
+
+-- slow operation hook
+slow = {};
+ifNotTrue( g:onSlow( 0, function( op, msec, detail )
+    slow[#slow + 1] = { op = op, msec = msec, detail = detail };
+    -- should not be called recursively
+    g:table('test');
+end) );
+ifNil( g:table('test') );
+ifNil( g:execute('select test') );
+ifNotEqual( #slow, 2 );
+ifNotEqual( slow[1].op, 'table' );
+ifNotEqual( type( slow[1].msec ), 'number' );
+ifNotEqual( slow[2].op, 'execute' );
+ifNotEqual( slow[2].detail, 'select test' );
+
+-- remove hook
+ifNotTrue( g:onSlow() );
+ifNil( g:table('test') );
+ifNotEqual( #slow, 2 );
+
+-- invalid threshold
+ifTrue( pcall( g.onSlow, g, -1, function() end ) );
+ifTrue( pcall( g.onSlow, g, 0/0, function() end ) );
+-- huge threshold is clamped
+ifNotTrue( g:onSlow( math.huge, function()
+    slow[#slow + 1] = true;
+end) );
+ifNil( g:table('test') );
+ifNotEqual( #slow, 2 );
+ifNotTrue( g:onSlow() );
+
+g:remove();
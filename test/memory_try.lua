@@ -0,0 +1,33 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local mem, t, c;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+t = ifNil( g:tableCreate({ name = 'test' }) );
+ifNil( t:columnCreate({ name = 'col', valType = 'UINT32', persistent = true }) );
+c = ifNil( t:column('col') );
+for name in t:columns() do end
+for name in g:tables() do end
+
+-- process
+mem = ifNil( groonga.memory() );
+for _, k in ipairs({ 'lua', 'rss', 'anon', 'file', 'mapped' }) do
+    ifNotEqual( type( mem[k] ), 'number' );
+end
+ifTrue( mem.rss < mem.anon + mem.file );
+ifTrue( mem.file < mem.mapped );
+
+-- database
+mem = ifNil( g:memory() );
+ifNotEqual( type( mem.mapped ), 'number' );
+ifNotEqual( mem.tables, 1 );
+ifNotEqual( mem.columns, 1 );
+ifNotEqual( mem.catalog, 1 );
+ifNotEqual( mem.columnCatalogs, 1 );
+ifNotEqual( mem.resolved, 1 );
+
+g:remove();
@@ -0,0 +1,44 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local path2 = './db/testdb2';
+local g = groonga.new( path );
+local g2 = groonga.new( path2 );
+local t, t2, c;
+
+if g then
+    g:remove();
+end
+if g2 then
+    g2:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+g2 = ifNil( groonga.new( path2, true ) );
+
+-- same name in different database
+t = ifNil( g:tableCreate({ name = 'test' }) );
+t2 = ifNil( g2:tableCreate({ name = 'test' }) );
+ifEqual( t, t2 );
+ifNotEqual( t, g:table('test') );
+ifNotEqual( t2, g2:table('test') );
+ifNotNil( g:table('unknown') );
+
+-- column reference
+c = ifNil( t:columnCreate({
+    name = 'testColumn',
+    type ='SCALAR',
+    valType = 'UINT32',
+    persistent = true
+}) );
+ifNotEqual( c, t:column('testColumn') );
+ifNotNil( t2:column('testColumn') );
+for name, col in t:columns( true ) do
+    ifNotEqual( c, col );
+end
+
+-- removed object should not be returned
+ifNotTrue( t:remove() );
+t = ifNil( g:tableCreate({ name = 'test' }) );
+ifNotNil( t:column('testColumn') );
+
+g:remove();
+g2:remove();
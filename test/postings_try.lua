@@ -0,0 +1,60 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local c, list;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+ifNil( g:execute('table_create Docs TABLE_NO_KEY') );
+ifNil( g:execute('column_create Docs body COLUMN_SCALAR Text') );
+ifNil( g:execute('table_create Terms TABLE_PAT_KEY ShortText --default_tokenizer TokenBigram --normalizer NormalizerAuto') );
+ifNil( g:execute('column_create Terms index COLUMN_INDEX|WITH_POSITION Docs body') );
+ifNil( g:execute('load --table Docs --values \'[{"body":"hello world"},{"body":"hello hello"},{"body":"world"}]\'') );
+c = ifNil( g:table('Terms'):column('index') );
+
+-- postings
+list = {};
+for rid, sid, pos, tf, weight in c:postings('hello') do
+    list[#list + 1] = { rid, tf };
+end
+ifNotEqual( #list, 2 );
+ifNotEqual( list[1][1], 1 );
+ifNotEqual( list[1][2], 1 );
+ifNotEqual( list[2][1], 2 );
+ifNotEqual( list[2][2], 2 );
+
+-- term is normalized
+list = {};
+for rid in c:postings('HELLO') do
+    list[#list + 1] = rid;
+end
+ifNotEqual( #list, 2 );
+
+-- positions
+list = {};
+for rid, sid, pos in c:postings( 'hello', { withPositions = true } ) do
+    list[#list + 1] = { rid, pos };
+end
+ifNotEqual( #list, 3 );
+ifNotEqual( list[2][1], 2 );
+ifNotEqual( list[3][1], 2 );
+ifEqual( list[2][2], list[3][2] );
+
+-- unknown term
+for rid in c:postings('unknown') do
+    ifTrue( true );
+end
+
+-- estimate size
+ifNotEqual( type( c:estimateSize('hello') ), 'number' );
+ifEqual( c:estimateSize('hello'), 0 );
+ifNotEqual( c:estimateSize('unknown'), 0 );
+
+-- not index column
+c = ifNil( g:table('Docs'):column('body') );
+ifNotNil( c:postings('hello') );
+ifNotNil( c:estimateSize('hello') );
+
+g:remove();
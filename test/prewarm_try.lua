@@ -0,0 +1,44 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local t, stat;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+t = ifNil( g:tableCreate({ name = 'test' }) );
+ifNil( t:columnCreate({
+    name = 'testColumn',
+    type ='SCALAR',
+    valType = 'UINT32',
+    persistent = true
+}) );
+
+-- whole database
+for _, mode in ipairs({ 'willneed', 'touch' }) do
+    stat = ifNil( g:prewarm({ mode = mode }) );
+    ifEqual( stat.files, 0 );
+end
+
+-- specified objects
+stat = ifNil( g:prewarm({
+    tables = { 'test' },
+    columns = { 'test.testColumn' },
+    threads = 2
+}) );
+ifEqual( stat.files, 0 );
+
+-- pinned pages; mlock may fail by RLIMIT_MEMLOCK
+local err;
+stat, err = g:prewarm({ mode = 'lock', tables = { 'test' } });
+if not stat then
+    ifNotEqual( type( err ), 'string' );
+end
+ifNil( g:prewarm({ mode = 'lock', columns = { 'test.testColumn' } }) or err );
+
+-- unknown object
+ifNotNil( g:prewarm({ tables = { 'unknown' } }) );
+ifNotNil( g:prewarm({ columns = { 'test' } }) );
+
+g:remove();
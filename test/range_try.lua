@@ -0,0 +1,61 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local c, rids;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+ifNil( g:execute('table_create Events TABLE_NO_KEY') );
+ifNil( g:execute('column_create Events at COLUMN_SCALAR Time') );
+ifNil( g:execute('column_create Events score COLUMN_SCALAR Int32') );
+ifNil( g:execute('column_create Events tag COLUMN_SCALAR ShortText') );
+ifNil( g:execute('table_create Times TABLE_PAT_KEY Time') );
+ifNil( g:execute('column_create Times index COLUMN_INDEX Events at') );
+ifNil( g:execute('table_create Scores TABLE_PAT_KEY Int32') );
+ifNil( g:execute('column_create Scores index COLUMN_INDEX Events score') );
+ifNil( g:execute('table_create Tags TABLE_HASH_KEY ShortText') );
+ifNil( g:execute('column_create Tags index COLUMN_INDEX Events tag') );
+ifNil( g:execute('load --table Events --values \'[' ..
+                 '{"at":1000,"score":10,"tag":"a"},' ..
+                 '{"at":2000,"score":20,"tag":"b"},' ..
+                 '{"at":3000,"score":10,"tag":"a"}]\'') );
+
+-- time range in seconds
+c = ifNil( g:table('Times'):column('index') );
+rids = ifNil( c:range({ min = 1500, max = 3000 }) );
+ifNotEqual( #rids, 2 );
+ifNotEqual( rids[1], 2 );
+ifNotEqual( rids[2], 3 );
+rids = ifNil( c:range({ min = 1500, desc = true }) );
+ifNotEqual( #rids, 2 );
+ifNotEqual( rids[1], 3 );
+ifNotEqual( rids[2], 2 );
+rids = ifNil( c:range({ limit = 1 }) );
+ifNotEqual( #rids, 1 );
+ifNotEqual( rids[1], 1 );
+ifNotEqual( #ifNil( c:range() ), 3 );
+ifNotEqual( #ifNil( c:range({ min = 5000 }) ), 0 );
+
+-- records that have same key
+c = ifNil( g:table('Scores'):column('index') );
+rids = ifNil( c:range({ max = 10 }) );
+ifNotEqual( #rids, 2 );
+ifNotEqual( rids[1], 1 );
+ifNotEqual( rids[2], 3 );
+ifTrue( pcall( c.range, c, { min = 'x' } ) );
+ifTrue( pcall( c.range, c, { max = 2^40 } ) );
+ifTrue( pcall( c.range, c, { min = 1.5 } ) );
+ifTrue( pcall( c.range, c, { max = 0/0 } ) );
+
+-- bounds of 64bit integer
+c = ifNil( g:table('Times'):column('index') );
+ifTrue( pcall( c.range, c, { max = 2^63 } ) );
+ifTrue( pcall( c.range, c, { min = 1.0000001 } ) );
+ifNotEqual( #ifNil( c:range({ min = 1.5 }) ), 3 );
+
+-- lexicon of non-numeric keys
+ifNotNil( g:table('Tags'):column('index'):range() );
+
+g:remove();
@@ -0,0 +1,44 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local ro, t, c;
+
+if g then
+    g:remove();
+end
+
+-- create and readonly cannot be used together
+ifTrue( pcall( groonga.new, path, { create = true, readonly = true } ) );
+
+g = ifNil( groonga.new( path, { create = true } ) );
+ifNil( g:tableCreate({ name = 'test' }) );
+ifNil( g:table('test'):columnCreate({
+    name = 'testColumn',
+    type ='SCALAR',
+    valType = 'UINT32',
+    persistent = true
+}) );
+
+g = nil;
+collectgarbage('collect');
+
+-- open read-only database
+ro = ifNil( groonga.new( path, { readonly = true } ) );
+ifNotEqual( ro, groonga.new( path, { readonly = true } ) );
+
+-- reject DDL
+ifNotNil( ro:tableCreate({ name = 'test2' }) );
+t = ifNil( ro:table('test') );
+ifNotNil( t:columnCreate({ name = 'test2' }) );
+ifTrue( t:rename('test2') );
+ifTrue( t:remove() );
+c = ifNil( t:column('testColumn') );
+ifTrue( c:rename('test2') );
+ifTrue( c:remove() );
+ifTrue( ro:touch() );
+ifTrue( ro:remove() );
+
+-- writable database does not share a reference with read-only one
+g = ifNil( groonga.new( path ) );
+ifEqual( g, ro );
+g:remove();
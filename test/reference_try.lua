@@ -0,0 +1,48 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local users, items, c, t, out;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+users = ifNil( g:tableCreate({
+    name = 'Users',
+    type = 'HASH_KEY',
+    keyType = 'SHORT_TEXT'
+}) );
+ifNil( users:columnCreate({ name = 'age', valType = 'UINT32', persistent = true }) );
+items = ifNil( g:tableCreate({
+    name = 'Items',
+    type = 'HASH_KEY',
+    keyType = 'SHORT_TEXT'
+}) );
+
+-- reference column by table name and table object
+c = ifNil( items:columnCreate({ name = 'owner', valType = 'Users', persistent = true }) );
+ifNotEqual( c:valType(), 'Users' );
+c = ifNil( items:columnCreate({
+    name = 'buyers',
+    type = 'VECTOR',
+    valType = users,
+    persistent = true
+}) );
+ifNotEqual( c:valType(), 'Users' );
+
+-- table that keyed by records of other table
+t = ifNil( g:tableCreate({ name = 'Scores', type = 'PAT_KEY', keyType = users }) );
+ifNotEqual( t:keyType(), 'Users' );
+
+-- invalid types
+ifTrue( pcall( items.columnCreate, items, { name = 'x', valType = 'Unknown' } ) );
+ifTrue( pcall( items.columnCreate, items, { name = 'x', valType = 'Items.owner' } ) );
+ifTrue( pcall( items.columnCreate, items, { name = 'x', valType = c } ) );
+
+-- join through the reference column
+ifNil( g:execute('load --table Users --values \'[{"_key":"alice","age":20}]\'') );
+ifNil( g:execute('load --table Items --values \'[{"_key":"book","owner":"alice"}]\'') );
+out = ifNil( g:execute('select Items --output_columns _key,owner._key,owner.age') );
+ifNil( out:find( '"alice",20', 1, true ) );
+
+g:remove();
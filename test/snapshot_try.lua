@@ -0,0 +1,41 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local dest = './db/snapshot';
+local g = groonga.new( path );
+local snap = groonga.new( dest .. '/testdb' );
+local stat, out;
+
+if g then
+    g:remove();
+end
+if snap then
+    snap:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+ifNil( g:execute('table_create Users TABLE_HASH_KEY ShortText') );
+ifNil( g:execute('column_create Users age COLUMN_SCALAR UInt32') );
+ifNil( g:execute('load --table Users --values \'[{"_key":"alice","age":20}]\'') );
+
+-- copy
+stat = ifNil( g:snapshot( dest ) );
+ifEqual( stat.files, 0 );
+ifEqual( stat.bytes, 0 );
+ifNotEqual( type( stat.cloned ), 'number' );
+ifTrue( g:isLocked() );
+
+-- snapshot is not locked and has the same records
+snap = ifNil( groonga.new( dest .. '/testdb' ) );
+ifTrue( snap:isLocked() );
+ifNil( snap:table('Users'):column('age') );
+out = ifNil( snap:execute('select Users --output_columns _key,age') );
+ifNil( out:find( 'alice', 1, true ) );
+
+-- existing files are not overwritten
+ifNotNil( g:snapshot( dest ) );
+ifTrue( g:isLocked() );
+
+-- temporary database
+ifNotNil( groonga.new():snapshot( dest ) );
+
+snap:remove();
+g:remove();
@@ -0,0 +1,39 @@
+local groonga = require('groonga');
+local path = './db/testdb';
+local g = groonga.new( path );
+local stats, t;
+
+if g then
+    g:remove();
+end
+g = ifNil( groonga.new( path, true ) );
+
+stats = ifNil( g:stats() );
+ifNotEqual( stats.open.count, 1 );
+ifNotEqual( type( stats.open.p50 ), 'number' );
+
+-- count operations
+t = ifNil( g:tableCreate({ name = 'test' }) );
+ifNil( t:columnCreate({ name = 'col', valType = 'UINT32', persistent = true }) );
+for i = 1, 100 do
+    ifNil( g:table('test') );
+    ifNil( t:column('col') );
+end
+ifNil( g:execute('select test') );
+
+stats = g:stats();
+ifNotEqual( stats.ddl.count, 2 );
+ifNotEqual( stats.table.count, 100 );
+ifNotEqual( stats.column.count, 100 );
+ifNotEqual( stats.execute.count, 1 );
+ifTrue( stats.table.min > stats.table.p50 );
+ifTrue( stats.table.p50 > stats.table.p99 );
+ifTrue( stats.table.p99 > stats.table.max );
+
+-- reset
+g:resetStats();
+stats = g:stats();
+ifNotEqual( stats.table.count, 0 );
+ifNotNil( stats.table.p50 );
+
+g:remove();
@@ -33,6 +33,30 @@ for name, tbl in iter do
 end
 
 
+-- getting all table name with table id
+for name, id in g:tables('id') do
+    ifNil( tbls[name] );
+    ifNotEqual( type( id ), 'number' );
+end
+
+-- getting all table name with reusable table obj
+local light;
+local cached = g:table('test3');
+for name, tbl in g:tables('light') do
+    ifNil( tbls[name] );
+    ifNotEqual( tbl:name(), name );
+    -- cached table obj is returned as is
+    if name == 'test3' then
+        ifNotEqual( tbl, cached );
+    end
+    light = tbl;
+end
+ifNil( light );
+cached = nil;
+
+-- invalid mode
+ifTrue( pcall( g.tables, g, 'unknown' ) );
+
 -- getting all table name with table obj
 for name, tbl in g:tables(true) do
     ifNil( tbls[name] );
@@ -44,4 +68,28 @@ for name, tbl in g:tables(true) do
 end
 ifNotEqual( nelts, 0 );
 
+-- catalog should be updated after the schema changed
+ifNil( g:tableCreate({ name = 'added' }) );
+ifNil( g:table('test1'):columnCreate({
+    name = 'col', valType = 'UINT32', persistent = true
+}) );
+ifNotTrue( g:table('test2'):remove() );
+for name in g:tables() do
+    tbls[name] = true;
+end
+ifNil( tbls.added );
+ifNotNil( tbls['test1.col'] );
+ifNotNil( tbls.test2 );
+
+-- column of reusable table obj is owned by the cached table obj
+local col;
+collectgarbage();
+for name, tbl in g:tables('light') do
+    if name == 'test1' then
+        col = ifNil( tbl:column('col') );
+    end
+end
+ifNotEqual( col:table():name(), 'test1' );
+ifNotEqual( col:table(), g:table('test1') );
+
 g:remove();